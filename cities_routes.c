@@ -1,16 +1,83 @@
+// Habilita as declarações POSIX (sockets, threads) mesmo quando o compilador está em modo C estrito.
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE         // Habilita também MAP_ANONYMOUS (memória compartilhada da execução particionada).
+#define _DARWIN_C_SOURCE        // O mesmo no macOS, onde _POSIX_C_SOURCE esconde as extensões do sistema.
+
 // Inclusão das bibliotecas padrão necessárias para o programa.
 #include <stdio.h>      // Para entrada e saída padrão (printf, scanf)
 #include <stdlib.h>     // Para alocação de memória (malloc, free, exit)
 #include <string.h>     // Para manipulação de strings (strcpy, strncpy, strcspn)
 #include <stdbool.h>    // Para usar o tipo booleano (true, false)
+#include <stdint.h>     // Para tipos inteiros de tamanho fixo (uint64_t) usados no bitmap de cidades ativas
 #include <limits.h>     // Para usar constantes como INT_MAX
 #include <locale.h>     // Para configuração de localização (idioma, formato de números, etc.)
+#include <unistd.h>     // Para chamadas POSIX de arquivos (read, write, close, unlink, pipe)
+#include <errno.h>      // Para errno (leituras e escritas interrompidas por sinais)
+#include <fcntl.h>      // Para fcntl (sockets não bloqueantes no modo servidor)
+#include <sys/socket.h> // Para sockets (modo servidor)
+#include <sys/un.h>     // Para endereços de sockets de domínio Unix
+#include <poll.h>       // Para o laço de eventos do modo servidor
+#include <pthread.h>    // Para as threads trabalhadoras do modo servidor
+#include <signal.h>     // Para tratar SIGINT/SIGTERM/SIGPIPE no modo servidor
+#include <sched.h>      // Para sched_yield (espera pelos leitores de um snapshot antigo)
+#include <stdatomic.h>  // Para a publicação atômica de snapshots
+#include <time.h>       // Para clock_gettime (medição das consultas no modo benchmark)
+#include <sys/mman.h>   // Para mmap (segmentos de memória compartilhada da execução particionada)
+#include <sys/wait.h>   // Para waitpid (encerramento dos processos da execução particionada)
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>  // Para as instruções SIMD do Floyd–Warshall de todos os pares
+#endif
 
 // Definições de constantes para limites e valores especiais.
+#ifndef MAX_CIDADES             // Pode ser alterado na compilação (ex.: -DMAX_CIDADES=4096 para o modo benchmark).
 #define MAX_CIDADES 50          // Número máximo de cidades que podem ser cadastradas.
+#endif
 #define MAX_NOME_CIDADE 50    // Comprimento máximo para o nome de uma cidade.
 #define INFINITO INT_MAX        // Representa uma distância infinita, útil no algoritmo de Dijkstra.
 
+// Tamanho dos blocos (em cidades) do Floyd–Warshall de todos os pares: com 64, cada bloco de uma
+// matriz ocupa 16 KB e os blocos usados juntos cabem na cache. Deve ser múltiplo de 16 (largura do AVX-512).
+#ifndef TAMANHO_BLOCO_APSP
+#define TAMANHO_BLOCO_APSP 64
+#endif
+#if TAMANHO_BLOCO_APSP % 16 != 0
+#error "TAMANHO_BLOCO_APSP deve ser múltiplo de 16"
+#endif
+#define INFINITO_TABELA (INT32_MAX / 2) // "Infinito" da tabela de todos os pares: a soma de dois não estoura.
+
+// Conjunto de instruções usado pelo Floyd–Warshall (escolhido na compilação, ex.: -march=native).
+#if defined(__AVX512F__)
+#define NOME_SIMD_APSP "AVX-512"
+#elif defined(__AVX2__)
+#define NOME_SIMD_APSP "AVX2"
+#else
+#define NOME_SIMD_APSP "escalar"
+#endif
+
+// Parâmetros do modo servidor: threads trabalhadoras e clientes conectados simultaneamente.
+#define NUM_TRABALHADORES 4
+#define MAX_CLIENTES 64
+#define TEMPO_LIMITE_ESCRITA_MS 2000    // Tempo máximo para enviar uma resposta a um cliente que não a lê.
+// Códigos das operações do protocolo binário do servidor.
+#define OP_SERVIDOR_DIJKSTRA 1          // Argumentos: [origem, destino]       -> custo seguido das cidades do caminho.
+#define OP_SERVIDOR_CADASTRAR_ROTA 2    // Argumentos: [origem, destino, peso] -> sem dados (escrita).
+#define OP_SERVIDOR_ISOCRONA 3          // Argumentos: [origem, limite]        -> pares (cidade, custo) por custo crescente.
+// Códigos de status das respostas do servidor.
+#define STATUS_OK 0
+#define STATUS_ARGUMENTO_INVALIDO 1
+#define STATUS_OPERACAO_DESCONHECIDA 2
+
+// Parâmetros do modo benchmark: total de consultas por medição e custo máximo das isócronas.
+#define CONSULTAS_BENCHMARK 256
+#define LIMITE_ISOCRONA_BENCHMARK 1000
+#define MAX_CIDADES_APSP_BENCHMARK 1024 // Maior mapa em que a tabela de todos os pares é medida (custo cúbico).
+#define NUM_PARTICOES_BENCHMARK 4       // Processos da consulta particionada no modo benchmark.
+#define CONSULTAS_PARTICIONADAS_BENCHMARK 32 // Consultas particionadas medidas por mapa (cada uma percorre o mapa todo).
+
+// Parâmetros da execução particionada em processos.
+#define MAX_PARTICOES 16                // Maior número de processos (partições) de uma execução.
+#define MAX_SUPERPASSOS_PARTICIONADOS (MAX_CIDADES + 1) // Superpassos registrados (Bellman-Ford: até uma rota a mais por superpasso).
+
 // Estrutura para representar um nó em uma lista de rotas (arestas do grafo).
 // Cada nó contém o ID da cidade de destino da rota e o peso (custo) da rota.
 typedef struct NoRota {
@@ -19,23 +86,261 @@ typedef struct NoRota {
     struct NoRota* proximo;   // Ponteiro para o próximo nó na lista de rotas.
 } NoRota;
 
-// Estrutura para representar uma cidade (vértice do grafo).
-// Contém informações sobre a cidade, como ID, nome, uma lista de rotas que partem dela,
-// e um indicador se a cidade está ativa no mapa.
-typedef struct Cidade {
-    int id;                         // Identificador único da cidade.
-    char nome[MAX_NOME_CIDADE];     // Nome da cidade.
-    NoRota* listaRotas;             // Ponteiro para o início da lista de rotas que partem desta cidade.
-    bool ativa;                     // Indica se a cidade está atualmente em uso no mapa.
-} Cidade;
+// Número de palavras de 64 bits necessárias para o bitmap de cidades ativas.
+#define PALAVRAS_BITMAP_CIDADES ((MAX_CIDADES + 63) / 64)
+// Tamanho da arena de nomes: espaço para todos os nomes mais a string vazia compartilhada na posição 0.
+#define TAMANHO_ARENA_NOMES (MAX_CIDADES * MAX_NOME_CIDADE + 1)
 
 // Estrutura para representar o mapa de cidades (o grafo em si).
-// Contém um array de todas as cidades possíveis e o número de cidades atualmente ativas.
+// Os dados das cidades (vértices) ficam separados em arrays paralelos, indexados pelo ID da cidade:
+// os dados "quentes" (bitmap de ativas e início das listas de rotas) são lidos a cada passo dos
+// algoritmos de busca, enquanto os nomes ("frios") só são lidos ao imprimir resultados.
+// Assim, os laços internos do Dijkstra não trazem para o cache bytes de nomes que não usam.
 typedef struct MapaCidades {
-    Cidade cidades[MAX_CIDADES];    // Array que armazena os dados de todas as cidades.
-    int numCidadesAtivas;           // Contador do número de cidades que foram cadastradas e estão ativas.
+    uint64_t cidadesAtivas[PALAVRAS_BITMAP_CIDADES]; // Bitmap: o bit i ligado indica que a cidade i está ativa.
+    NoRota* listaRotas[MAX_CIDADES];                 // Início da lista de rotas que partem de cada cidade.
+    int offsetNome[MAX_CIDADES];                     // Posição do nome de cada cidade dentro da arena de nomes.
+    char arenaNomes[TAMANHO_ARENA_NOMES];            // Arena contígua com os nomes das cidades (terminados em '\0').
+    int tamanhoArena;                                // Quantidade de bytes já ocupados na arena de nomes.
+    int numCidadesAtivas;                            // Contador do número de cidades que foram cadastradas e estão ativas.
+    unsigned long versao;                            // Versão dos dados: incrementada a cada cidade ou rota cadastrada.
+    struct TabelaDistancias* todosOsPares;           // Tabela de todos os pares (NULL se nunca calculada).
 } MapaCidades;
 
+// Verifica se a cidade de ID 'id' está ativa (teste de um único bit no bitmap).
+static inline bool cidadeAtiva(const MapaCidades* mapa, int id) {
+    return (mapa->cidadesAtivas[id >> 6] >> (id & 63)) & 1u;
+}
+
+// Marca a cidade de ID 'id' como ativa no bitmap.
+static inline void marcarCidadeAtiva(MapaCidades* mapa, int id) {
+    mapa->cidadesAtivas[id >> 6] |= (uint64_t)1 << (id & 63);
+}
+
+// Retorna o nome da cidade de ID 'id' (string vazia se a cidade nunca foi cadastrada).
+static inline const char* nomeCidade(const MapaCidades* mapa, int id) {
+    return &mapa->arenaNomes[mapa->offsetNome[id]];
+}
+
+
+// ---------------------------------------------------------------------------------------------
+// Estatísticas por consulta (instrumentação opcional dos algoritmos).
+// As funções de consulta recebem um ponteiro EstatisticasConsulta*: com NULL nada é contado (o custo
+// é um teste de ponteiro por evento); compilando com -DSEM_ESTATISTICAS a contagem é removida por completo.
+// ---------------------------------------------------------------------------------------------
+
+#define MAX_NIVEIS_ESTATISTICAS 32   // Níveis de fronteira registrados (os mais profundos somam no último).
+#define NUM_FAIXAS_HISTOGRAMA 24     // Faixas de potência de 2 dos histogramas agregados.
+
+// Fases de uma consulta cujo tempo é medido separadamente.
+#define FASE_INICIALIZACAO 0         // Preparação dos arrays de trabalho.
+#define FASE_BUSCA 1                 // Laço principal do algoritmo.
+#define NUM_FASES_CONSULTA 2
+
+// Operações com estatísticas agregadas (uma entrada em cada array de AgregadoEstatisticas).
+#define ESTATISTICAS_DIJKSTRA 0
+#define ESTATISTICAS_ISOCRONA 1
+#define NUM_OPERACOES_ESTATISTICAS 2
+
+// Nomes das operações e das fases nos relatórios.
+static const char* const nomesOperacoesEstatisticas[NUM_OPERACOES_ESTATISTICAS] = {"dijkstra", "isocrona"};
+static const char* const nomesFasesConsulta[NUM_FASES_CONSULTA] = {"inicialização", "busca"};
+
+// Define as estatísticas de uma única consulta, preenchidas pela função que a executa.
+// O Dijkstra ponto a ponto e a isócrona usam o heap binário indexado da área de trabalho: "inserções"
+// contam as entradas reais no heap (uma por cidade alcançada; as reduções de custo de quem já está no
+// heap são contadas só em "relaxadas") e "remoções" as extrações do mínimo.
+typedef struct EstatisticasConsulta {
+    long verticesFixados;                            // Cidades com distância definitiva.
+    long arestasInspecionadas;                       // Rotas percorridas nas listas de adjacência.
+    long arestasRelaxadas;                           // Rotas que melhoraram a distância de uma cidade.
+    long insercoesFila;                              // Inserções no heap (sem contar as reduções de custo).
+    long remocoesFila;                               // Extrações do mínimo do heap.
+    int numNiveis;                                   // Níveis usados em 'tamanhoFronteira' (0 se não se aplica).
+    long tamanhoFronteira[MAX_NIVEIS_ESTATISTICAS];  // Vértices descobertos em cada nível da busca.
+    long bytesAlocados;                              // Memória de trabalho escrita pela consulta.
+    double tempoFase[NUM_FASES_CONSULTA];            // Tempo de cada fase, em microssegundos.
+} EstatisticasConsulta;
+
+// Define as estatísticas agregadas de várias consultas de uma mesma operação (somas e histogramas).
+// A faixa i dos histogramas conta os valores em [2^(i-1), 2^i - 1] (a faixa 0 conta o valor 0).
+typedef struct AgregadoEstatisticas {
+    long consultas;
+    long somaVerticesFixados, somaArestasInspecionadas, somaArestasRelaxadas;
+    long somaInsercoesFila, somaRemocoesFila, somaBytesAlocados;
+    double somaTempoFase[NUM_FASES_CONSULTA];
+    long histogramaTempo[NUM_FAIXAS_HISTOGRAMA];     // Tempo total da consulta (µs).
+    long histogramaArestas[NUM_FAIXAS_HISTOGRAMA];   // Arestas inspecionadas.
+    long histogramaFronteira[NUM_FAIXAS_HISTOGRAMA]; // Maior fronteira (0 se a operação não tem níveis).
+} AgregadoEstatisticas;
+
+#ifdef SEM_ESTATISTICAS
+// Sem instrumentação a coleta nunca é ativada ("--estatisticas" é recusada): como a constante é conhecida
+// na compilação, os relatórios do menu e do servidor também são removidos.
+#define estatisticasAtivas false
+// 'valor' só aparece dentro de sizeof (não é avaliado), para que as variáveis usadas apenas nos contadores
+// não fiquem sem uso.
+#define CONTAR_ESTATISTICA(estatisticas, campo, valor) ((void)sizeof(valor))
+#else
+// Ativada pela opção "--estatisticas": o menu e o servidor passam a coletar e relatar estatísticas.
+static bool estatisticasAtivas = false;
+
+// Soma 'valor' ao contador 'campo' quando a coleta está ativa para esta consulta.
+#define CONTAR_ESTATISTICA(estatisticas, campo, valor) \
+    do { if (estatisticas) (estatisticas)->campo += (valor); } while (0)
+#endif
+
+// Retorna o instante atual em microssegundos (relógio monotônico).
+double agoraMicrossegundos(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec * 1e6 + (double)t.tv_nsec / 1e3;
+}
+
+// Zera as estatísticas e registra a memória de trabalho. Retorna o instante inicial da primeira fase
+// (0 quando a coleta está desativada, para não consultar o relógio).
+static inline double iniciarEstatisticas(EstatisticasConsulta* estatisticas, long bytesAlocados) {
+#ifndef SEM_ESTATISTICAS
+    if (estatisticas) {
+        memset(estatisticas, 0, sizeof(*estatisticas));
+        estatisticas->bytesAlocados = bytesAlocados;
+        return agoraMicrossegundos();
+    }
+#endif
+    (void)estatisticas;
+    (void)bytesAlocados;
+    return 0;
+}
+
+// Encerra a fase 'fase', somando o tempo desde '*marca', e reinicia a marca para a fase seguinte.
+static inline void encerrarFase(EstatisticasConsulta* estatisticas, int fase, double* marca) {
+#ifndef SEM_ESTATISTICAS
+    if (estatisticas) {
+        double agora = agoraMicrossegundos();
+        estatisticas->tempoFase[fase] += agora - *marca;
+        *marca = agora;
+    }
+#endif
+    (void)estatisticas;
+    (void)fase;
+    (void)marca;
+}
+
+// Conta um vértice descoberto no nível 'nivel' da busca.
+static inline void contarFronteira(EstatisticasConsulta* estatisticas, int nivel) {
+#ifndef SEM_ESTATISTICAS
+    if (estatisticas) {
+        if (nivel >= MAX_NIVEIS_ESTATISTICAS) nivel = MAX_NIVEIS_ESTATISTICAS - 1;
+        if (nivel >= estatisticas->numNiveis) estatisticas->numNiveis = nivel + 1;
+        estatisticas->tamanhoFronteira[nivel]++;
+    }
+#endif
+    (void)estatisticas;
+    (void)nivel;
+}
+
+// Retorna a faixa do histograma de um valor não negativo (número de bits significativos, limitado).
+int faixaHistograma(long valor) {
+    int faixa = 0;
+    while (valor > 0 && faixa < NUM_FAIXAS_HISTOGRAMA - 1) {
+        valor >>= 1;
+        faixa++;
+    }
+    return faixa;
+}
+
+// Soma as estatísticas de uma consulta ao agregado da sua operação.
+void acumularEstatisticas(AgregadoEstatisticas* agregado, const EstatisticasConsulta* estatisticas) {
+    double tempoTotal = 0;
+    long maiorFronteira = 0;
+    for (int f = 0; f < NUM_FASES_CONSULTA; f++) {
+        agregado->somaTempoFase[f] += estatisticas->tempoFase[f];
+        tempoTotal += estatisticas->tempoFase[f];
+    }
+    for (int n = 0; n < estatisticas->numNiveis; n++) {
+        if (estatisticas->tamanhoFronteira[n] > maiorFronteira) maiorFronteira = estatisticas->tamanhoFronteira[n];
+    }
+    agregado->consultas++;
+    agregado->somaVerticesFixados += estatisticas->verticesFixados;
+    agregado->somaArestasInspecionadas += estatisticas->arestasInspecionadas;
+    agregado->somaArestasRelaxadas += estatisticas->arestasRelaxadas;
+    agregado->somaInsercoesFila += estatisticas->insercoesFila;
+    agregado->somaRemocoesFila += estatisticas->remocoesFila;
+    agregado->somaBytesAlocados += estatisticas->bytesAlocados;
+    agregado->histogramaTempo[faixaHistograma((long)tempoTotal)]++;
+    agregado->histogramaArestas[faixaHistograma(estatisticas->arestasInspecionadas)]++;
+    agregado->histogramaFronteira[faixaHistograma(maiorFronteira)]++;
+}
+
+// Soma o agregado 'origem' ao agregado 'destino' (usado para juntar os agregados de várias threads).
+void combinarAgregados(AgregadoEstatisticas* destino, const AgregadoEstatisticas* origem) {
+    destino->consultas += origem->consultas;
+    destino->somaVerticesFixados += origem->somaVerticesFixados;
+    destino->somaArestasInspecionadas += origem->somaArestasInspecionadas;
+    destino->somaArestasRelaxadas += origem->somaArestasRelaxadas;
+    destino->somaInsercoesFila += origem->somaInsercoesFila;
+    destino->somaRemocoesFila += origem->somaRemocoesFila;
+    destino->somaBytesAlocados += origem->somaBytesAlocados;
+    for (int f = 0; f < NUM_FASES_CONSULTA; f++) destino->somaTempoFase[f] += origem->somaTempoFase[f];
+    for (int i = 0; i < NUM_FAIXAS_HISTOGRAMA; i++) {
+        destino->histogramaTempo[i] += origem->histogramaTempo[i];
+        destino->histogramaArestas[i] += origem->histogramaArestas[i];
+        destino->histogramaFronteira[i] += origem->histogramaFronteira[i];
+    }
+}
+
+// Imprime as estatísticas de uma consulta.
+void imprimirEstatisticas(const EstatisticasConsulta* estatisticas) {
+    printf("  [estatísticas] vértices fixados: %ld | arestas inspecionadas: %ld | relaxadas: %ld\n",
+           estatisticas->verticesFixados, estatisticas->arestasInspecionadas, estatisticas->arestasRelaxadas);
+    printf("  [estatísticas] inserções na fila: %ld | remoções: %ld | memória de trabalho: %ld bytes\n",
+           estatisticas->insercoesFila, estatisticas->remocoesFila, estatisticas->bytesAlocados);
+    printf("  [estatísticas] tempo (µs):");
+    for (int f = 0; f < NUM_FASES_CONSULTA; f++) {
+        printf(" %s %.1f", nomesFasesConsulta[f], estatisticas->tempoFase[f]);
+    }
+    printf("\n");
+    if (estatisticas->numNiveis > 0) {
+        printf("  [estatísticas] fronteira por nível:");
+        for (int n = 0; n < estatisticas->numNiveis; n++) printf(" %ld", estatisticas->tamanhoFronteira[n]);
+        printf("\n");
+    }
+}
+
+// Imprime em 'saida' as médias e os histogramas de cada operação com consultas registradas.
+void imprimirHistogramas(FILE* saida, const AgregadoEstatisticas agregados[]) {
+    for (int op = 0; op < NUM_OPERACOES_ESTATISTICAS; op++) {
+        const AgregadoEstatisticas* agregado = &agregados[op];
+        if (agregado->consultas == 0) continue;
+        double n = (double)agregado->consultas;
+        fprintf(saida, "\n=== Estatísticas agregadas: %s (%ld consultas) ===\n",
+                nomesOperacoesEstatisticas[op], agregado->consultas);
+        fprintf(saida, "Médias: vértices fixados %.1f, arestas inspecionadas %.1f, relaxadas %.1f, "
+                "inserções %.1f, remoções %.1f, memória %.0f bytes\n",
+                (double)agregado->somaVerticesFixados / n, (double)agregado->somaArestasInspecionadas / n,
+                (double)agregado->somaArestasRelaxadas / n, (double)agregado->somaInsercoesFila / n,
+                (double)agregado->somaRemocoesFila / n, (double)agregado->somaBytesAlocados / n);
+        fprintf(saida, "Tempo médio por fase (µs):");
+        for (int f = 0; f < NUM_FASES_CONSULTA; f++) {
+            fprintf(saida, " %s %.1f", nomesFasesConsulta[f], agregado->somaTempoFase[f] / n);
+        }
+        fprintf(saida, "\n%-22s %12s %12s %12s\n", "Faixa", "tempo (µs)", "arestas", "fronteira");
+        for (int i = 0; i < NUM_FAIXAS_HISTOGRAMA; i++) {
+            if (agregado->histogramaTempo[i] == 0 && agregado->histogramaArestas[i] == 0 &&
+                agregado->histogramaFronteira[i] == 0) continue;
+            long minimo = i == 0 ? 0 : 1L << (i - 1), maximo = i == 0 ? 0 : (1L << i) - 1;
+            char faixa[32];
+            if (i == NUM_FAIXAS_HISTOGRAMA - 1) snprintf(faixa, sizeof(faixa), "[%ld, ...]", minimo);
+            else snprintf(faixa, sizeof(faixa), "[%ld, %ld]", minimo, maximo);
+            fprintf(saida, "%-22s %12ld %12ld %12ld\n", faixa, agregado->histogramaTempo[i],
+                    agregado->histogramaArestas[i], agregado->histogramaFronteira[i]);
+        }
+    }
+}
+
+// Agregados das consultas feitas pelo menu (relatados ao sair quando "--estatisticas" está ativa).
+static AgregadoEstatisticas agregadosMenu[NUM_OPERACOES_ESTATISTICAS];
+
 
 // Função para criar um novo nó de rota.
 // Aloca memória para um NoRota, inicializa seus campos com o destino e peso fornecidos,
@@ -54,10 +359,11 @@ NoRota* criarNoRota(int idDestino, int peso) {
 
 // Função para adicionar uma nova rota à lista de rotas de uma cidade de origem.
 // Cria um novo nó de rota e o insere no início da lista de adjacências da cidade de origem.
-void adicionarRotaNaLista(Cidade* cidadeOrigem, int idDestino, int peso) {
-    NoRota* novaRota = criarNoRota(idDestino, peso); // Cria o nó da nova rota.
-    novaRota->proximo = cidadeOrigem->listaRotas;   // O próximo da nova rota aponta para o início da lista atual.
-    cidadeOrigem->listaRotas = novaRota;            // A nova rota se torna o início da lista.
+void adicionarRotaNaLista(MapaCidades* mapa, int idOrigem, int idDestino, int peso) {
+    NoRota* novaRota = criarNoRota(idDestino, peso);   // Cria o nó da nova rota.
+    novaRota->proximo = mapa->listaRotas[idOrigem];    // O próximo da nova rota aponta para o início da lista atual.
+    mapa->listaRotas[idOrigem] = novaRota;             // A nova rota se torna o início da lista.
+    mapa->versao++;                                    // O mapa mudou: avança a versão.
 }
 
 // Função para criar e inicializar o mapa de cidades.
@@ -69,20 +375,39 @@ MapaCidades* criarMapaCidades() {
         perror("Erro ao alocar memória para MapaCidades");
         exit(EXIT_FAILURE);
     }
+    memset(mapa->cidadesAtivas, 0, sizeof(mapa->cidadesAtivas)); // Todas as cidades começam inativas.
+    mapa->arenaNomes[0] = '\0'; // A posição 0 da arena guarda a string vazia, compartilhada pelas cidades sem nome.
+    mapa->tamanhoArena = 1;
     // Itera por todas as posições possíveis de cidades no mapa.
+    // O ID da cidade é o próprio índice nos arrays.
     for (int i = 0; i < MAX_CIDADES; i++) {
-        mapa->cidades[i].id = i;                     // Define o ID da cidade (baseado no índice).
-        strcpy(mapa->cidades[i].nome, "");           // Inicializa o nome da cidade como vazio.
-        mapa->cidades[i].listaRotas = NULL;          // Inicializa a lista de rotas como nula.
-        mapa->cidades[i].ativa = false;              // Define a cidade como inativa.
+        mapa->offsetNome[i] = 0;                     // Inicializa o nome da cidade como vazio.
+        mapa->listaRotas[i] = NULL;                  // Inicializa a lista de rotas como nula.
     }
     mapa->numCidadesAtivas = 0; // Inicializa o contador de cidades ativas.
+    mapa->versao = 0;           // Inicializa a versão dos dados.
+    mapa->todosOsPares = NULL;  // A tabela de todos os pares só é calculada sob demanda.
     printf("Mapa de cidades inicializado.\n");
     return mapa; // Retorna o ponteiro para o mapa criado.
 }
 
+// Função que ativa o slot 'id' com o nome fornecido (já limitado a 'tamanhoNome' caracteres).
+// Não faz validações nem imprime mensagens: é usada por cadastrarCidade e pelos geradores do benchmark.
+void ativarCidade(MapaCidades* mapa, int id, const char* nome, int tamanhoNome) {
+    marcarCidadeAtiva(mapa, id); // Marca a cidade como ativa.
+    // Copia o nome para o fim da arena e termina com '\0'.
+    // Como cada slot é usado uma única vez, a arena nunca precisa de mais que TAMANHO_ARENA_NOMES bytes.
+    mapa->offsetNome[id] = mapa->tamanhoArena;
+    memcpy(&mapa->arenaNomes[mapa->tamanhoArena], nome, (size_t)tamanhoNome);
+    mapa->arenaNomes[mapa->tamanhoArena + tamanhoNome] = '\0'; // Garante terminação nula.
+    mapa->tamanhoArena += tamanhoNome + 1;
+    mapa->listaRotas[id] = NULL; // Inicializa a lista de rotas (cidade nova não tem rotas ainda).
+    mapa->numCidadesAtivas++;    // Incrementa o contador de cidades ativas.
+    mapa->versao++;              // O mapa mudou: avança a versão.
+}
+
 // Função para cadastrar uma nova cidade no mapa.
-// Procura por um slot de cidade inativo, define suas informações (nome),
+// Procura por um slot de cidade inativo, copia o nome para a arena de nomes,
 // marca como ativa e incrementa o contador de cidades ativas.
 // Retorna o ID da cidade cadastrada ou -1 se o limite for atingido.
 int cadastrarCidade(MapaCidades* mapa, const char* nome) {
@@ -92,13 +417,11 @@ int cadastrarCidade(MapaCidades* mapa, const char* nome) {
     }
     // Procura por um slot de cidade inativo.
     for (int i = 0; i < MAX_CIDADES; i++) {
-        if (!mapa->cidades[i].ativa) { // Se encontrar um slot inativo.
-            mapa->cidades[i].ativa = true; // Marca a cidade como ativa.
-            // Copia o nome fornecido para a cidade, com cuidado para não exceder o buffer.
-            strncpy(mapa->cidades[i].nome, nome, MAX_NOME_CIDADE - 1);
-            mapa->cidades[i].nome[MAX_NOME_CIDADE - 1] = '\0'; // Garante terminação nula.
-            mapa->cidades[i].listaRotas = NULL; // Inicializa a lista de rotas (cidade nova não tem rotas ainda).
-            mapa->numCidadesAtivas++;           // Incrementa o contador de cidades ativas.
+        if (!cidadeAtiva(mapa, i)) { // Se encontrar um slot inativo.
+            // Limita o nome a MAX_NOME_CIDADE - 1 caracteres (o restante é descartado).
+            int tamanhoNome = 0;
+            while (tamanhoNome < MAX_NOME_CIDADE - 1 && nome[tamanhoNome] != '\0') tamanhoNome++;
+            ativarCidade(mapa, i, nome, tamanhoNome);
             printf("Cidade '%s' (ID: %d) cadastrada.\n", nome, i);
             return i; // Retorna o ID da cidade cadastrada.
         }
@@ -106,26 +429,40 @@ int cadastrarCidade(MapaCidades* mapa, const char* nome) {
     return -1; // Caso algo inesperado ocorra (não deveria, se numCidadesAtivas está correto).
 }
 
-// Função para cadastrar uma rota entre duas cidades.
-// Verifica se os IDs das cidades de origem e destino são válidos e se as cidades estão ativas.
-// Também verifica se o peso da rota é não negativo.
-// Se tudo estiver correto, adiciona a rota à lista da cidade de origem.
-void cadastrarRota(MapaCidades* mapa, int idOrigem, int idDestino, int peso) {
+// Resultados de inserirRota.
+#define ROTA_CADASTRADA 0         // A rota foi adicionada ao mapa.
+#define ROTA_CIDADE_INVALIDA 1    // Origem ou destino com ID inválido ou cidade inativa.
+#define ROTA_PESO_NEGATIVO 2      // O peso informado é negativo.
+
+// Adiciona uma rota entre duas cidades sem imprimir nada (usada pelo menu e pelo modo servidor).
+// Verifica se os IDs das cidades são válidos e ativos e se o peso é não negativo.
+// Retorna ROTA_CADASTRADA ou o motivo da recusa.
+int inserirRota(MapaCidades* mapa, int idOrigem, int idDestino, int peso) {
     // Validação dos IDs das cidades e se estão ativas.
-    if (idOrigem < 0 || idOrigem >= MAX_CIDADES || !mapa->cidades[idOrigem].ativa ||
-        idDestino < 0 || idDestino >= MAX_CIDADES || !mapa->cidades[idDestino].ativa) {
+    if (idOrigem < 0 || idOrigem >= MAX_CIDADES || !cidadeAtiva(mapa, idOrigem) ||
+        idDestino < 0 || idDestino >= MAX_CIDADES || !cidadeAtiva(mapa, idDestino)) {
+        return ROTA_CIDADE_INVALIDA;
+    }
+    if (peso < 0) return ROTA_PESO_NEGATIVO; // Validação do peso da rota.
+    // Adiciona a rota na lista de adjacências da cidade de origem.
+    adicionarRotaNaLista(mapa, idOrigem, idDestino, peso);
+    return ROTA_CADASTRADA;
+}
+
+// Função para cadastrar uma rota entre duas cidades e informar o resultado.
+void cadastrarRota(MapaCidades* mapa, int idOrigem, int idDestino, int peso) {
+    int resultado = inserirRota(mapa, idOrigem, idDestino, peso);
+    if (resultado == ROTA_CIDADE_INVALIDA) {
         printf("Erro: ID de cidade inválido ou cidade não ativa para cadastrar rota.\n");
         return;
     }
-    if (peso < 0) { // Validação do peso da rota.
+    if (resultado == ROTA_PESO_NEGATIVO) {
         printf("Erro: O peso da rota não pode ser negativo.\n");
         return;
     }
-    // Adiciona a rota na lista de adjacências da cidade de origem.
-    adicionarRotaNaLista(&mapa->cidades[idOrigem], idDestino, peso);
     printf("Rota de %s (ID: %d) para %s (ID: %d) com peso %d cadastrada.\n",
-           mapa->cidades[idOrigem].nome, idOrigem,
-           mapa->cidades[idDestino].nome, idDestino, peso);
+           nomeCidade(mapa, idOrigem), idOrigem,
+           nomeCidade(mapa, idDestino), idDestino, peso);
 }
 
 // Função para visualizar todas as cidades cadastradas e suas respectivas rotas.
@@ -139,17 +476,17 @@ void visualizarCidadesERotas(MapaCidades* mapa) {
     }
     // Itera por todas as cidades.
     for (int i = 0; i < MAX_CIDADES; i++) {
-        if (mapa->cidades[i].ativa) { // Se a cidade estiver ativa.
-            printf("Cidade: %s (ID: %d)\n", mapa->cidades[i].nome, i);
-            NoRota* rota = mapa->cidades[i].listaRotas; // Obtém a lista de rotas da cidade.
+        if (cidadeAtiva(mapa, i)) { // Se a cidade estiver ativa.
+            printf("Cidade: %s (ID: %d)\n", nomeCidade(mapa, i), i);
+            NoRota* rota = mapa->listaRotas[i]; // Obtém a lista de rotas da cidade.
             if (rota == NULL) { // Se não houver rotas.
                 printf("  Nenhuma rota saindo desta cidade.\n");
             } else { // Se houver rotas.
-                printf("  Rotas saindo de %s:\n", mapa->cidades[i].nome);
+                printf("  Rotas saindo de %s:\n", nomeCidade(mapa, i));
                 // Itera pela lista de rotas.
                 while (rota != NULL) {
                     printf("    -> Para: %s (ID: %d), Peso: %d\n",
-                           mapa->cidades[rota->idCidadeDestino].nome, rota->idCidadeDestino, rota->peso);
+                           nomeCidade(mapa, rota->idCidadeDestino), rota->idCidadeDestino, rota->peso);
                     rota = rota->proximo; // Move para a próxima rota na lista.
                 }
             }
@@ -157,127 +494,1149 @@ void visualizarCidadesERotas(MapaCidades* mapa) {
     }
 }
 
-// Função auxiliar para o algoritmo de Dijkstra.
-// Encontra o vértice (cidade ativa) que ainda não foi incluído na árvore de caminhos mínimos (sptSet)
-// e que possui a menor distância conhecida a partir da origem.
-// Retorna o ID da cidade com menor distância, ou -1 se não houver mais cidades acessíveis.
-int menorDistancia(int dist[], bool sptSet[], int numVerticesAtivosNoGrafo, const Cidade cidades[]) {
-    int min = INFINITO, min_index = -1; // Inicializa a distância mínima e o índice.
+// Define a área de trabalho reutilizável das buscas de caminho (Dijkstra e isócronas).
+// Em vez de reinicializar arrays de MAX_CIDADES posições a cada consulta, cada cidade tocada recebe a
+// marca da geração atual: reiniciar a área só avança 'geracao' (O(1)), e uma cidade com marca antiga
+// vale como não tocada (custo INFINITO, sem predecessor, fora do heap). Assim o custo de uma consulta
+// é proporcional à região explorada e não ao tamanho do mapa.
+// Uma área atende uma consulta por vez; por padrão cada thread usa a sua (areaTrabalhoDaThread).
+typedef struct AreaTrabalho {
+    uint32_t geracao;                    // Geração da consulta atual.
+    int numTocadas;                      // Cidades tocadas na consulta atual.
+    uint32_t geracaoToque[MAX_CIDADES];  // geracaoToque[v] == geracao: os campos abaixo valem para v.
+    int dist[MAX_CIDADES];               // Menor custo conhecido até cada cidade.
+    int pred[MAX_CIDADES];               // Predecessor de cada cidade no caminho mínimo (-1 se não há).
+    int posicaoHeap[MAX_CIDADES];        // Posição da cidade no heap (-1 se fora dele).
+    bool fixada[MAX_CIDADES];            // true se o custo da cidade já é definitivo.
+    int heap[MAX_CIDADES];               // Heap binário de mínimo (por 'dist') com as cidades pendentes.
+    int tamanhoHeap;
+} AreaTrabalho;
+
+// Bytes da área escritos por cidade tocada (para as estatísticas de memória de trabalho).
+#define BYTES_AREA_POR_CIDADE (sizeof(uint32_t) + 4 * sizeof(int) + sizeof(bool))
+
+// Função que cria uma área de trabalho sem nenhuma cidade tocada.
+AreaTrabalho* criarAreaTrabalho() {
+    AreaTrabalho* area = (AreaTrabalho*)malloc(sizeof(AreaTrabalho));
+    if (!area) {
+        perror("Erro ao alocar memória para a área de trabalho");
+        exit(EXIT_FAILURE);
+    }
+    memset(area->geracaoToque, 0, sizeof(area->geracaoToque));
+    area->geracao = 0;
+    area->numTocadas = 0;
+    area->tamanhoHeap = 0;
+    return area;
+}
+
+// Função que libera uma área de trabalho.
+void liberarAreaTrabalho(AreaTrabalho* area) {
+    free(area);
+}
+
+// Prepara a área para uma nova consulta, esquecendo todas as cidades tocadas pela anterior em O(1).
+static inline void reiniciarAreaTrabalho(AreaTrabalho* area) {
+    // Quando o contador dá a volta (a cada 2^32 consultas), marcas antigas poderiam coincidir com a
+    // geração nova: só nesse caso as marcas são limpas de fato.
+    if (++area->geracao == 0) {
+        memset(area->geracaoToque, 0, sizeof(area->geracaoToque));
+        area->geracao = 1;
+    }
+    area->numTocadas = 0;
+    area->tamanhoHeap = 0;
+}
+
+// Inicializa a cidade 'v' na consulta atual (custo INFINITO, sem predecessor, fora do heap), se ainda
+// não tiver sido tocada.
+static inline void tocarCidade(AreaTrabalho* area, int v) {
+    if (area->geracaoToque[v] == area->geracao) return;
+    area->geracaoToque[v] = area->geracao;
+    area->dist[v] = INFINITO;
+    area->pred[v] = -1;
+    area->posicaoHeap[v] = -1;
+    area->fixada[v] = false;
+    area->numTocadas++;
+}
+
+// Retorna o menor custo conhecido até a cidade na consulta atual (INFINITO se não foi tocada).
+static inline int custoNaArea(const AreaTrabalho* area, int v) {
+    return area->geracaoToque[v] == area->geracao ? area->dist[v] : INFINITO;
+}
+
+// Chave da área de trabalho de cada thread, criada uma única vez.
+static pthread_key_t chaveAreaTrabalho;
+static pthread_once_t chaveAreaTrabalhoCriada = PTHREAD_ONCE_INIT;
+
+// Destrutor chamado quando uma thread que usou a sua área termina.
+static void destruirAreaTrabalhoDaThread(void* area) {
+    liberarAreaTrabalho((AreaTrabalho*)area);
+}
+
+static void criarChaveAreaTrabalho(void) {
+    pthread_key_create(&chaveAreaTrabalho, destruirAreaTrabalhoDaThread);
+}
+
+// Retorna a área de trabalho da thread chamadora, criando-a no primeiro uso. É a área usada quando
+// uma busca recebe NULL, e é liberada automaticamente quando a thread termina.
+AreaTrabalho* areaTrabalhoDaThread() {
+    pthread_once(&chaveAreaTrabalhoCriada, criarChaveAreaTrabalho);
+    AreaTrabalho* area = (AreaTrabalho*)pthread_getspecific(chaveAreaTrabalho);
+    if (area == NULL) {
+        area = criarAreaTrabalho();
+        pthread_setspecific(chaveAreaTrabalho, area);
+    }
+    return area;
+}
 
-    // Itera por todos os vértices (cidades).
-    for (int v_idx = 0; v_idx < MAX_CIDADES; ++v_idx) {
-        // Considera apenas cidades ativas, não incluídas no sptSet e com distância menor que 'min'.
-        if (cidades[v_idx].ativa && !sptSet[v_idx] && dist[v_idx] <= min) {
-            min = dist[v_idx];      // Atualiza a distância mínima.
-            min_index = v_idx;      // Atualiza o índice da cidade com menor distância.
+// Libera a área de trabalho da thread chamadora, se houver (a thread principal não passa pelo
+// destrutor ao sair de main).
+void liberarAreaTrabalhoDaThread() {
+    pthread_once(&chaveAreaTrabalhoCriada, criarChaveAreaTrabalho);
+    liberarAreaTrabalho((AreaTrabalho*)pthread_getspecific(chaveAreaTrabalho));
+    pthread_setspecific(chaveAreaTrabalho, NULL);
+}
+
+// Retorna true se a cidade 'a' deve sair do heap antes da cidade 'b': menor custo e, no empate, maior
+// ID (a mesma ordem em que a busca linear original escolhia as cidades).
+static inline bool precedeNoHeap(const AreaTrabalho* area, int a, int b) {
+    return area->dist[a] < area->dist[b] || (area->dist[a] == area->dist[b] && a > b);
+}
+
+// Troca duas posições do heap, mantendo 'posicaoHeap' atualizado.
+static inline void trocarNoHeap(AreaTrabalho* area, int i, int j) {
+    int a = area->heap[i], b = area->heap[j];
+    area->heap[i] = b;
+    area->heap[j] = a;
+    area->posicaoHeap[b] = i;
+    area->posicaoHeap[a] = j;
+}
+
+// Sobe a entrada da posição 'i' do heap até restaurar a ordem (após inserção ou redução de custo).
+static inline void subirNoHeap(AreaTrabalho* area, int i) {
+    while (i > 0) {
+        int pai = (i - 1) / 2;
+        if (!precedeNoHeap(area, area->heap[i], area->heap[pai])) break;
+        trocarNoHeap(area, i, pai);
+        i = pai;
+    }
+}
+
+// Remove e retorna a cidade de menor custo do heap.
+static inline int removerMinimoDoHeap(AreaTrabalho* area) {
+    int minimo = area->heap[0];
+    area->tamanhoHeap--;
+    area->posicaoHeap[minimo] = -1;
+    if (area->tamanhoHeap > 0) {
+        area->heap[0] = area->heap[area->tamanhoHeap];
+        area->posicaoHeap[area->heap[0]] = 0;
+        // Desce a nova raiz até restaurar a ordem.
+        int i = 0;
+        for (;;) {
+            int menor = i, esquerda = 2 * i + 1, direita = 2 * i + 2;
+            if (esquerda < area->tamanhoHeap && precedeNoHeap(area, area->heap[esquerda], area->heap[menor])) menor = esquerda;
+            if (direita < area->tamanhoHeap && precedeNoHeap(area, area->heap[direita], area->heap[menor])) menor = direita;
+            if (menor == i) break;
+            trocarNoHeap(area, i, menor);
+            i = menor;
         }
     }
-    return min_index; // Retorna o índice da cidade encontrada.
+    return minimo;
+}
+
+// Reduz o custo conhecido da cidade 'v' (já tocada) para 'custo', inserindo-a no heap se ainda não
+// estiver nele. Retorna true se a cidade entrou no heap agora (e não apenas teve o custo reduzido).
+static inline bool reduzirCustoNoHeap(AreaTrabalho* area, int v, int custo) {
+    area->dist[v] = custo;
+    bool inserida = area->posicaoHeap[v] == -1;
+    if (inserida) {
+        area->posicaoHeap[v] = area->tamanhoHeap;
+        area->heap[area->tamanhoHeap++] = v;
+    }
+    subirNoHeap(area, area->posicaoHeap[v]);
+    return inserida;
 }
 
 // Função recursiva para imprimir o caminho de uma cidade de origem até uma cidade de destino 'j',
 // utilizando o array de predecessores 'pred' gerado pelo algoritmo de Dijkstra.
-void imprimirCaminho(MapaCidades* mapa, int pred[], int j) {
+void imprimirCaminho(const MapaCidades* mapa, const int pred[], int j) {
     if (pred[j] == -1) { // Caso base: chegou na cidade de origem (ou não há caminho).
-        printf("%s (ID: %d)", mapa->cidades[j].nome, j);
+        printf("%s (ID: %d)", nomeCidade(mapa, j), j);
         return;
     }
     imprimirCaminho(mapa, pred, pred[j]); // Chamada recursiva para o predecessor.
-    printf(" -> %s (ID: %d)", mapa->cidades[j].nome, j); // Imprime a cidade atual.
+    printf(" -> %s (ID: %d)", nomeCidade(mapa, j), j); // Imprime a cidade atual.
 }
 
-// Implementação do algoritmo de Dijkstra para encontrar o menor caminho entre duas cidades.
-// Recebe o mapa, ID da cidade de origem e ID da cidade de destino.
-// Calcula e imprime o menor custo e o caminho correspondente.
-void dijkstra(MapaCidades* mapa, int idOrigem, int idDestino) {
-    // Validação dos IDs de origem e destino.
-    if (idOrigem < 0 || idOrigem >= MAX_CIDADES || !mapa->cidades[idOrigem].ativa ||
-        idDestino < 0 || idDestino >= MAX_CIDADES || !mapa->cidades[idDestino].ativa) {
-        printf("Erro: ID de cidade de origem ou destino inválido para Dijkstra.\n");
-        return;
-    }
+// Define a tabela de menores caminhos entre todos os pares de cidades (Floyd–Warshall em blocos).
+// As matrizes são densas, indexadas pelo ID da cidade, com 'dimensao' linhas e colunas (o maior ID
+// ativo + 1, arredondado para múltiplo de TAMANHO_BLOCO_APSP) e alinhadas a 64 bytes para o SIMD.
+// A tabela vale apenas para a versão do mapa em que foi calculada: qualquer cidade ou rota cadastrada
+// depois avança 'mapa->versao' e a invalida, e as consultas voltam a usar o Dijkstra.
+typedef struct TabelaDistancias {
+    int dimensao;             // Linhas (e colunas) de cada matriz.
+    int32_t* dist;            // dist[i * dimensao + j]: menor custo de i até j (INFINITO_TABELA se não há caminho).
+    int32_t* proximo;         // proximo[i * dimensao + j]: cidade seguinte a i no menor caminho até j (-1 se não há).
+    unsigned long versao;     // Versão do mapa usada no cálculo.
+    bool custosAtingemLimite; // Algum caminho pode custar INFINITO_TABELA ou mais: nesses pares a tabela não sabe
+                              // distinguir "sem caminho" de "caminho caro", e a consulta é refeita pelo Dijkstra.
+} TabelaDistancias;
+
+// Retorna true se o mapa tem uma tabela de todos os pares calculada para a sua versão atual.
+static inline bool tabelaTodosOsParesValida(const MapaCidades* mapa) {
+    return mapa->todosOsPares != NULL && mapa->todosOsPares->versao == mapa->versao;
+}
+
+// Retorna true se a tabela (válida) tem a resposta exata do par: custos abaixo de INFINITO_TABELA são
+// sempre exatos, e INFINITO_TABELA só significa "sem caminho" quando nenhum caminho pode atingir o limite.
+static inline bool tabelaRespondePar(const TabelaDistancias* tabela, int idOrigem, int idDestino) {
+    return !tabela->custosAtingemLimite ||
+           tabela->dist[(size_t)idOrigem * (size_t)tabela->dimensao + (size_t)idDestino] < INFINITO_TABELA;
+}
 
-    int dist[MAX_CIDADES];     // Array para armazenar as menores distâncias da origem até cada cidade.
-    bool sptSet[MAX_CIDADES];  // Array booleano: true se a cidade i está incluída na árvore de caminhos mínimos.
-    int pred[MAX_CIDADES];     // Array para armazenar o predecessor de cada cidade no caminho mínimo.
+// Atualiza o bloco (bi, bj) da tabela com os caminhos que passam pelas cidades do bloco bk:
+// dist[i][j] = min(dist[i][j], dist[i][k] + dist[k][j]) para i, j e k nos respectivos blocos, e o
+// próximo salto de i até j passa a ser o de i até k quando o caminho melhora. Como os pesos não são
+// negativos, a linha e a coluna k não mudam durante a iteração k, então os blocos podem coincidir.
+// A soma nunca estoura: dist[i][k] < INFINITO_TABELA e dist[k][j] <= INFINITO_TABELA (que é INT32_MAX / 2),
+// e o mínimo com o valor atual (<= INFINITO_TABELA) mantém a tabela saturada em INFINITO_TABELA.
+static void relaxarBlocoTodosOsPares(TabelaDistancias* tabela, int bi, int bj, int bk) {
+    const size_t n = (size_t)tabela->dimensao;
+    for (int k = bk; k < bk + TAMANHO_BLOCO_APSP; k++) {
+        const int32_t* linhaK = &tabela->dist[(size_t)k * n + (size_t)bj];
+        for (int i = bi; i < bi + TAMANHO_BLOCO_APSP; i++) {
+            int32_t distIK = tabela->dist[(size_t)i * n + (size_t)k];
+            if (distIK >= INFINITO_TABELA) continue; // k não é alcançável a partir de i.
+            int32_t proximoIK = tabela->proximo[(size_t)i * n + (size_t)k];
+            int32_t* linhaI = &tabela->dist[(size_t)i * n + (size_t)bj];
+            int32_t* proximoI = &tabela->proximo[(size_t)i * n + (size_t)bj];
+#if defined(__AVX512F__)
+            // 16 colunas por instrução.
+            __m512i vDistIK = _mm512_set1_epi32(distIK), vProximoIK = _mm512_set1_epi32(proximoIK);
+            for (int j = 0; j < TAMANHO_BLOCO_APSP; j += 16) {
+                __m512i soma = _mm512_add_epi32(vDistIK, _mm512_load_si512(linhaK + j));
+                __m512i atual = _mm512_load_si512(linhaI + j);
+                __mmask16 melhora = _mm512_cmplt_epi32_mask(soma, atual);
+                _mm512_store_si512(linhaI + j, _mm512_mask_blend_epi32(melhora, atual, soma));
+                _mm512_store_si512(proximoI + j,
+                                   _mm512_mask_blend_epi32(melhora, _mm512_load_si512(proximoI + j), vProximoIK));
+            }
+#elif defined(__AVX2__)
+            // 8 colunas por instrução.
+            __m256i vDistIK = _mm256_set1_epi32(distIK), vProximoIK = _mm256_set1_epi32(proximoIK);
+            for (int j = 0; j < TAMANHO_BLOCO_APSP; j += 8) {
+                __m256i soma = _mm256_add_epi32(vDistIK, _mm256_load_si256((const __m256i*)(linhaK + j)));
+                __m256i atual = _mm256_load_si256((const __m256i*)(linhaI + j));
+                __m256i melhora = _mm256_cmpgt_epi32(atual, soma);
+                _mm256_store_si256((__m256i*)(linhaI + j), _mm256_min_epi32(atual, soma));
+                __m256i proximoAtual = _mm256_load_si256((const __m256i*)(proximoI + j));
+                _mm256_store_si256((__m256i*)(proximoI + j), _mm256_blendv_epi8(proximoAtual, vProximoIK, melhora));
+            }
+#else
+            // Versão escalar (o compilador ainda pode vetorizá-la com as extensões disponíveis).
+            for (int j = 0; j < TAMANHO_BLOCO_APSP; j++) {
+                int32_t soma = distIK + linhaK[j];
+                if (soma < linhaI[j]) {
+                    linhaI[j] = soma;
+                    proximoI[j] = proximoIK;
+                }
+            }
+#endif
+        }
+    }
+}
 
-    // Inicialização dos arrays.
+// Calcula os menores caminhos entre todos os pares de cidades ativas sem imprimir nada.
+// Monta as matrizes densas a partir das listas de rotas e executa o Floyd–Warshall em blocos de
+// TAMANHO_BLOCO_APSP x TAMANHO_BLOCO_APSP (que cabem na cache): para cada bloco k, primeiro o bloco
+// da diagonal, depois os blocos da sua linha e coluna, e por fim todos os demais.
+// Retorna a tabela nova (que pertence ao chamador) ou NULL se não houver cidades ativas.
+TabelaDistancias* calcularTodosOsPares(const MapaCidades* mapa) {
+    // A dimensão vai até o maior ID ativo, arredondada para um número inteiro de blocos.
+    int maiorId = -1;
     for (int i = 0; i < MAX_CIDADES; i++) {
-        dist[i] = INFINITO;     // Distância inicial de todas as cidades é infinita.
-        sptSet[i] = false;      // Nenhuma cidade está no sptSet inicialmente.
-        pred[i] = -1;           // Predecessor inicial é -1 (sem predecessor).
+        if (cidadeAtiva(mapa, i)) maiorId = i;
     }
+    if (maiorId < 0) return NULL;
+    int dimensao = (maiorId + TAMANHO_BLOCO_APSP) / TAMANHO_BLOCO_APSP * TAMANHO_BLOCO_APSP;
+    size_t n = (size_t)dimensao;
 
-    dist[idOrigem] = 0; // A distância da cidade de origem para ela mesma é 0.
+    TabelaDistancias* tabela = (TabelaDistancias*)malloc(sizeof(TabelaDistancias));
+    // O tamanho de cada matriz é múltiplo de 64 bytes, como o aligned_alloc exige.
+    int32_t* dist = (int32_t*)aligned_alloc(64, n * n * sizeof(int32_t));
+    int32_t* proximo = (int32_t*)aligned_alloc(64, n * n * sizeof(int32_t));
+    if (!tabela || !dist || !proximo) {
+        perror("Erro ao alocar memória para a tabela de todos os pares");
+        exit(EXIT_FAILURE);
+    }
+    tabela->dimensao = dimensao;
+    tabela->dist = dist;
+    tabela->proximo = proximo;
+    tabela->versao = mapa->versao;
 
-    printf("\nCalculando menor caminho de %s (ID: %d) para %s (ID: %d) usando Dijkstra...\n",
-           mapa->cidades[idOrigem].nome, idOrigem, mapa->cidades[idDestino].nome, idDestino);
+    // Matriz de pesos: custo 0 para a própria cidade e o menor peso entre as rotas diretas (pesos a partir
+    // de INFINITO_TABELA ficam de fora). Um caminho mínimo usa cada par de cidades no máximo uma vez, então
+    // se a soma desses menores pesos não atinge INFINITO_TABELA nenhum caminho atinge.
+    tabela->custosAtingemLimite = false;
+    for (size_t i = 0; i < n * n; i++) {
+        dist[i] = INFINITO_TABELA;
+        proximo[i] = -1;
+    }
+    for (int u = 0; u <= maiorId; u++) {
+        if (!cidadeAtiva(mapa, u)) continue;
+        dist[(size_t)u * n + (size_t)u] = 0;
+        proximo[(size_t)u * n + (size_t)u] = u;
+        for (NoRota* rota = mapa->listaRotas[u]; rota != NULL; rota = rota->proximo) {
+            int v = rota->idCidadeDestino;
+            if (!cidadeAtiva(mapa, v)) continue;
+            if (rota->peso >= INFINITO_TABELA) tabela->custosAtingemLimite = true;
+            if (rota->peso >= dist[(size_t)u * n + (size_t)v]) continue;
+            dist[(size_t)u * n + (size_t)v] = rota->peso;
+            proximo[(size_t)u * n + (size_t)v] = v;
+        }
+    }
+    int64_t somaPesos = 0;
+    for (int u = 0; u <= maiorId; u++) {
+        for (int v = 0; v <= maiorId; v++) {
+            if (v != u && dist[(size_t)u * n + (size_t)v] < INFINITO_TABELA) somaPesos += dist[(size_t)u * n + (size_t)v];
+        }
+    }
+    if (somaPesos >= INFINITO_TABELA) tabela->custosAtingemLimite = true;
 
-    // Loop principal do Dijkstra: executa numCidadesAtivas - 1 vezes.
-    // (No pior caso, precisa processar todas as cidades ativas).
-    for (int count = 0; count < mapa->numCidadesAtivas -1; count++) {
-        // Escolhe a cidade com a menor distância conhecida que ainda não foi processada.
-        int u = menorDistancia(dist, sptSet, mapa->numCidadesAtivas, mapa->cidades);
+    // Floyd–Warshall em blocos.
+    for (int bk = 0; bk < dimensao; bk += TAMANHO_BLOCO_APSP) {
+        relaxarBlocoTodosOsPares(tabela, bk, bk, bk);                           // Bloco da diagonal.
+        for (int b = 0; b < dimensao; b += TAMANHO_BLOCO_APSP) {
+            if (b == bk) continue;
+            relaxarBlocoTodosOsPares(tabela, bk, b, bk);                        // Linha do bloco k.
+            relaxarBlocoTodosOsPares(tabela, b, bk, bk);                        // Coluna do bloco k.
+        }
+        for (int bi = 0; bi < dimensao; bi += TAMANHO_BLOCO_APSP) {
+            if (bi == bk) continue;
+            for (int bj = 0; bj < dimensao; bj += TAMANHO_BLOCO_APSP) {
+                if (bj != bk) relaxarBlocoTodosOsPares(tabela, bi, bj, bk);     // Demais blocos.
+            }
+        }
+    }
+    return tabela;
+}
 
-        if (u == -1) break; // Se não houver mais cidades alcançáveis, interrompe.
-        sptSet[u] = true;   // Marca a cidade 'u' como processada (incluída no sptSet).
+// Função que libera uma tabela de todos os pares.
+void liberarTabelaDistancias(TabelaDistancias* tabela) {
+    if (tabela == NULL) return;
+    free(tabela->dist);
+    free(tabela->proximo);
+    free(tabela);
+}
 
-        // Otimização: se a cidade 'u' escolhida é o destino e sua distância é finita,
-        // o menor caminho para o destino já foi encontrado.
-        if (u == idDestino && dist[u] != INFINITO) {
-             break;
-        }
+// Responde a uma consulta de menor caminho pela tabela (que deve ser válida para o mapa e responder o par,
+// ver tabelaRespondePar): preenche 'area->pred' ao longo do caminho armazenado, seguindo os próximos saltos
+// a partir da origem (a área já deve ter sido reiniciada), e retorna o custo (INFINITO se não houver caminho).
+int consultarTabelaTodosOsPares(const MapaCidades* mapa, int idOrigem, int idDestino, AreaTrabalho* area) {
+    const TabelaDistancias* tabela = mapa->todosOsPares;
+    const size_t n = (size_t)tabela->dimensao;
+    tocarCidade(area, idOrigem);
+    int32_t custo = tabela->dist[(size_t)idOrigem * n + (size_t)idDestino];
+    if (custo >= INFINITO_TABELA) return INFINITO;
+    for (int atual = idOrigem; atual != idDestino; ) {
+        int seguinte = tabela->proximo[(size_t)atual * n + (size_t)idDestino];
+        tocarCidade(area, seguinte);
+        area->pred[seguinte] = atual;
+        atual = seguinte;
+    }
+    return custo;
+}
+
+// Função que calcula a tabela de todos os pares do mapa, substituindo a anterior, e informa o tempo gasto.
+// Enquanto o mapa não mudar, as consultas de Dijkstra passam a ser respondidas pela tabela.
+void todosOsPares(MapaCidades* mapa) {
+    double inicio = agoraMicrossegundos();
+    TabelaDistancias* tabela = calcularTodosOsPares(mapa);
+    double tempo = agoraMicrossegundos() - inicio;
+    if (tabela == NULL) {
+        printf("Nenhuma cidade ativa no mapa.\n");
+        return;
+    }
+    liberarTabelaDistancias(mapa->todosOsPares);
+    mapa->todosOsPares = tabela;
+    printf("Tabela de menores caminhos entre todos os pares calculada (%d x %d, blocos de %d, %s) em %.2f ms.\n",
+           tabela->dimensao, tabela->dimensao, TAMANHO_BLOCO_APSP, NOME_SIMD_APSP, tempo / 1e3);
+    printf("As consultas de menor caminho usarão a tabela até a próxima alteração do mapa.\n");
+}
+
+// Implementação do algoritmo de Dijkstra sem impressão de resultados.
+// Calcula o menor custo da cidade de origem até a de destino (IDs já validados), usando o heap de
+// 'area' (NULL: a área da thread chamadora), e para assim que o destino tem custo definitivo.
+// O caminho fica em 'area->pred': o predecessor de cada cidade do caminho, do destino até a origem
+// (que tem predecessor -1). Se o mapa tem uma tabela de todos os pares válida que responde o par
+// (tabelaRespondePar), a resposta vem dela.
+// Se 'estatisticas' não for NULL, preenche-o com os contadores e tempos desta consulta.
+// Retorna o menor custo, ou INFINITO se não houver caminho.
+int calcularMenorCaminho(const MapaCidades* mapa, int idOrigem, int idDestino, AreaTrabalho* area,
+                         EstatisticasConsulta* estatisticas) {
+    if (area == NULL) area = areaTrabalhoDaThread();
+    double marca = iniciarEstatisticas(estatisticas, 0);
+    // Esquece as cidades tocadas pela consulta anterior (todas voltam a ter custo infinito).
+    reiniciarAreaTrabalho(area);
+
+    // Consulta à tabela de todos os pares, quando ela corresponde à versão atual do mapa.
+    if (tabelaTodosOsParesValida(mapa) && tabelaRespondePar(mapa->todosOsPares, idOrigem, idDestino)) {
+        int custo = consultarTabelaTodosOsPares(mapa, idOrigem, idDestino, area);
+        encerrarFase(estatisticas, FASE_BUSCA, &marca);
+        return custo;
+    }
+
+    // A distância da cidade de origem para ela mesma é 0.
+    tocarCidade(area, idOrigem);
+    reduzirCustoNoHeap(area, idOrigem, 0);
+    CONTAR_ESTATISTICA(estatisticas, insercoesFila, 1);
+    encerrarFase(estatisticas, FASE_INICIALIZACAO, &marca);
+
+    // Loop principal do Dijkstra: processa as cidades em ordem crescente de custo.
+    while (area->tamanhoHeap > 0) {
+        // Escolhe a cidade com a menor distância conhecida que ainda não foi processada.
+        int u = removerMinimoDoHeap(area);
+        area->fixada[u] = true; // Marca a cidade 'u' como processada (custo definitivo).
+        CONTAR_ESTATISTICA(estatisticas, remocoesFila, 1);
+        CONTAR_ESTATISTICA(estatisticas, verticesFixados, 1);
+
+        // Otimização: se a cidade 'u' escolhida é o destino, o menor caminho para ele já foi encontrado.
+        if (u == idDestino) break;
 
         // Atualiza as distâncias das cidades adjacentes à cidade 'u'.
-        NoRota* rota = mapa->cidades[u].listaRotas; // Obtém as rotas que partem de 'u'.
+        NoRota* rota = mapa->listaRotas[u]; // Obtém as rotas que partem de 'u'.
         while (rota != NULL) {
             int v = rota->idCidadeDestino; // ID da cidade vizinha.
-            // Se a cidade 'v' é ativa, não está no sptSet, 'u' é alcançável,
-            // e o caminho através de 'u' é mais curto para 'v'.
-            if (mapa->cidades[v].ativa && !sptSet[v] && dist[u] != INFINITO &&
-                dist[u] + rota->peso < dist[v]) {
-                dist[v] = dist[u] + rota->peso; // Atualiza a distância para 'v'.
-                pred[v] = u;                    // Define 'u' como predecessor de 'v'.
+            CONTAR_ESTATISTICA(estatisticas, arestasInspecionadas, 1);
+            // Se a cidade 'v' é ativa, ainda não foi processada e o caminho através de 'u' é mais curto.
+            if (cidadeAtiva(mapa, v)) {
+                tocarCidade(area, v);
+                // Compara sem somar primeiro, para não estourar o int com pesos grandes.
+                if (!area->fixada[v] && rota->peso < area->dist[v] - area->dist[u]) {
+                    bool inserida = reduzirCustoNoHeap(area, v, area->dist[u] + rota->peso);
+                    area->pred[v] = u; // Define 'u' como predecessor de 'v'.
+                    CONTAR_ESTATISTICA(estatisticas, arestasRelaxadas, 1);
+                    CONTAR_ESTATISTICA(estatisticas, insercoesFila, inserida ? 1 : 0);
+                }
             }
             rota = rota->proximo; // Próxima rota de 'u'.
         }
     }
+    CONTAR_ESTATISTICA(estatisticas, bytesAlocados, (long)((size_t)area->numTocadas * BYTES_AREA_POR_CIDADE));
+    encerrarFase(estatisticas, FASE_BUSCA, &marca);
+    return custoNaArea(area, idDestino);
+}
+
+// Implementação do algoritmo de Dijkstra para encontrar o menor caminho entre duas cidades.
+// Recebe o mapa, ID da cidade de origem e ID da cidade de destino.
+// Calcula e imprime o menor custo e o caminho correspondente.
+void dijkstra(MapaCidades* mapa, int idOrigem, int idDestino) {
+    // Validação dos IDs de origem e destino.
+    if (idOrigem < 0 || idOrigem >= MAX_CIDADES || !cidadeAtiva(mapa, idOrigem) ||
+        idDestino < 0 || idDestino >= MAX_CIDADES || !cidadeAtiva(mapa, idDestino)) {
+        printf("Erro: ID de cidade de origem ou destino inválido para Dijkstra.\n");
+        return;
+    }
+
+    printf("\nCalculando menor caminho de %s (ID: %d) para %s (ID: %d) usando Dijkstra...\n",
+           nomeCidade(mapa, idOrigem), idOrigem, nomeCidade(mapa, idDestino), idDestino);
+    if (tabelaTodosOsParesValida(mapa) && tabelaRespondePar(mapa->todosOsPares, idOrigem, idDestino)) {
+        printf("(Resposta obtida da tabela de todos os pares.)\n");
+    }
+
+    // O predecessor de cada cidade no caminho mínimo fica na área de trabalho da thread.
+    AreaTrabalho* area = areaTrabalhoDaThread();
+    // Com "--estatisticas", coleta os contadores da consulta, mostra-os e soma-os ao agregado do menu.
+    EstatisticasConsulta estatisticas;
+    int custo = calcularMenorCaminho(mapa, idOrigem, idDestino, area, estatisticasAtivas ? &estatisticas : NULL);
 
     // Impressão do resultado.
-    if (dist[idDestino] == INFINITO) { // Se a distância até o destino permaneceu infinita.
+    if (custo == INFINITO) { // Se a distância até o destino permaneceu infinita.
         printf("Não há caminho de %s (ID: %d) para %s (ID: %d).\n",
-               mapa->cidades[idOrigem].nome, idOrigem, mapa->cidades[idDestino].nome, idDestino);
+               nomeCidade(mapa, idOrigem), idOrigem, nomeCidade(mapa, idDestino), idDestino);
     } else { // Se um caminho foi encontrado.
         printf("Menor custo de %s (ID: %d) para %s (ID: %d) é: %d\n",
-               mapa->cidades[idOrigem].nome, idOrigem, mapa->cidades[idDestino].nome, idDestino, dist[idDestino]);
+               nomeCidade(mapa, idOrigem), idOrigem, nomeCidade(mapa, idDestino), idDestino, custo);
         printf("Caminho: ");
-        imprimirCaminho(mapa, pred, idDestino); // Imprime o caminho.
+        imprimirCaminho(mapa, area->pred, idDestino); // Imprime o caminho.
         printf("\n");
     }
+    if (estatisticasAtivas) {
+        imprimirEstatisticas(&estatisticas);
+        acumularEstatisticas(&agregadosMenu[ESTATISTICAS_DIJKSTRA], &estatisticas);
+    }
 }
 
-// Função para liberar toda a memória alocada dinamicamente para o mapa de cidades.
-// Itera por cada cidade ativa, liberando a memória de cada nó em sua lista de rotas.
-// Por fim, libera a memória da própria estrutura MapaCidades.
-void liberarMapaCidades(MapaCidades* mapa) {
-    if (mapa == NULL) return; // Se o mapa for nulo, não há nada a fazer.
+// Calcula a isócrona (área alcançável) a partir de uma ou mais cidades de origem sem imprimir nada:
+// todas as cidades cujo menor custo a partir da origem mais próxima é no máximo 'limite'.
+// É um único Dijkstra com heap binário e várias origens de custo 0, que não expande além do limite.
+// As origens devem ser IDs válidos e ativos (repetições são ignoradas). 'area' é a área de trabalho
+// usada (NULL: a da thread chamadora). Preenche 'alcancadas' e 'custos' em ordem crescente de custo e
+// retorna a quantidade de cidades alcançadas. Se 'estatisticas' não for NULL, preenche-o com os contadores.
+int calcularIsocrona(const MapaCidades* mapa, const int origens[], int numOrigens, int limite,
+                     AreaTrabalho* area, int alcancadas[], int custos[],
+                     EstatisticasConsulta* estatisticas) {
+    if (area == NULL) area = areaTrabalhoDaThread();
+    double marca = iniciarEstatisticas(estatisticas, 0);
+
+    // Esquece as cidades tocadas pela consulta anterior em O(1).
+    reiniciarAreaTrabalho(area);
+
+    // Todas as origens começam com custo 0.
+    for (int i = 0; i < numOrigens; i++) {
+        if (limite >= 0 && custoNaArea(area, origens[i]) == INFINITO) {
+            tocarCidade(area, origens[i]);
+            reduzirCustoNoHeap(area, origens[i], 0);
+            CONTAR_ESTATISTICA(estatisticas, insercoesFila, 1);
+        }
+    }
+    encerrarFase(estatisticas, FASE_INICIALIZACAO, &marca);
+
+    int numAlcancadas = 0;
+    while (area->tamanhoHeap > 0) {
+        // A cidade de menor custo pendente tem custo definitivo (e dentro do limite, pois só entram no heap
+        // cidades com custo <= limite).
+        int u = removerMinimoDoHeap(area);
+        area->fixada[u] = true;
+        alcancadas[numAlcancadas] = u;
+        custos[numAlcancadas++] = area->dist[u];
+        CONTAR_ESTATISTICA(estatisticas, remocoesFila, 1);
+        CONTAR_ESTATISTICA(estatisticas, verticesFixados, 1);
+
+        // Relaxa as rotas de 'u', descartando as que ultrapassam o limite.
+        for (NoRota* rota = mapa->listaRotas[u]; rota != NULL; rota = rota->proximo) {
+            int v = rota->idCidadeDestino;
+            CONTAR_ESTATISTICA(estatisticas, arestasInspecionadas, 1);
+            if (!cidadeAtiva(mapa, v)) continue;
+            tocarCidade(area, v);
+            if (area->fixada[v]) continue;
+            // Compara sem somar primeiro, para não estourar o int com pesos grandes.
+            if (rota->peso > limite - area->dist[u]) continue;
+            int custo = area->dist[u] + rota->peso;
+            if (custo < area->dist[v]) {
+                bool inserida = reduzirCustoNoHeap(area, v, custo);
+                CONTAR_ESTATISTICA(estatisticas, arestasRelaxadas, 1);
+                CONTAR_ESTATISTICA(estatisticas, insercoesFila, inserida ? 1 : 0);
+            }
+        }
+    }
+    CONTAR_ESTATISTICA(estatisticas, bytesAlocados, (long)((size_t)area->numTocadas * BYTES_AREA_POR_CIDADE));
+    encerrarFase(estatisticas, FASE_BUSCA, &marca);
+    return numAlcancadas;
+}
+
+// Função que calcula e imprime a isócrona a partir das cidades de origem fornecidas.
+// Valida as origens e o limite e lista as cidades alcançadas com seus custos, em ordem crescente de custo.
+void isocrona(MapaCidades* mapa, const int origens[], int numOrigens, int limite) {
+    // Validação das origens e do limite.
+    if (numOrigens <= 0 || limite < 0) {
+        printf("Erro: informe ao menos uma cidade de origem e um custo máximo não negativo.\n");
+        return;
+    }
+    for (int i = 0; i < numOrigens; i++) {
+        if (origens[i] < 0 || origens[i] >= MAX_CIDADES || !cidadeAtiva(mapa, origens[i])) {
+            printf("Erro: ID de cidade de origem inválido para a isócrona: %d.\n", origens[i]);
+            return;
+        }
+    }
+
+    printf("\nCidades alcançáveis com custo até %d a partir de:", limite);
+    for (int i = 0; i < numOrigens; i++) printf(" %s (ID: %d)", nomeCidade(mapa, origens[i]), origens[i]);
+    printf("\n");
+
+    int alcancadas[MAX_CIDADES], custos[MAX_CIDADES];
+    EstatisticasConsulta estatisticas;
+    int total = calcularIsocrona(mapa, origens, numOrigens, limite, NULL, alcancadas, custos,
+                                 estatisticasAtivas ? &estatisticas : NULL);
+    for (int i = 0; i < total; i++) {
+        printf("  %s (ID: %d) - custo %d\n", nomeCidade(mapa, alcancadas[i]), alcancadas[i], custos[i]);
+    }
+    if (estatisticasAtivas) {
+        imprimirEstatisticas(&estatisticas);
+        acumularEstatisticas(&agregadosMenu[ESTATISTICAS_ISOCRONA], &estatisticas);
+    }
+}
+
+// ---------------------------------------------------------------------------------------------
+// Execução particionada em vários processos.
+// A faixa de IDs é dividida em partições contíguas, e cada partição fica em um segmento de memória
+// compartilhada próprio (mmap anônimo compartilhado, criado antes do fork), atendido por um processo
+// trabalhador. Os menores custos a partir de uma origem são calculados em superpassos síncronos (BSP,
+// um Bellman-Ford por fronteira): cada processo relaxa as rotas das cidades da sua partição cujo custo
+// melhorou, aplica direto as relaxações locais e envia as remotas ao processo dono por anéis SPSC sem
+// travas; uma barreira entre processos separa a fase de envio da fase de recebimento.
+// Só são usados recursos portáveis (fork, pipe, mmap e atômicos do C11): o macOS, por exemplo, não tem
+// pthread_barrier_t nem prctl.
+// ---------------------------------------------------------------------------------------------
+
+// Comandos que o processo da partição 0 (o chamador) passa aos demais trabalhadores pelos pipes de
+// comando. O fim do pipe (o pai fechou a ponta de escrita ou morreu) encerra o trabalhador.
+#define COMANDO_PARTICAO_MENORES_CUSTOS 1
+
+// Esperas na barreira entre verificações de que o processo pai ainda existe.
+#define ESPERAS_ENTRE_VERIFICACOES_DO_PAI 1024
+
+// Mensagem de relaxação: um custo candidato para uma cidade de outra partição.
+typedef struct MensagemRelaxacao {
+    int cidade;       // Cidade de destino da rota (da partição que recebe a mensagem).
+    int custo;        // Custo até ela passando por 'predecessor'.
+    int predecessor;  // Cidade de origem da rota (da partição que envia).
+} MensagemRelaxacao;
+
+// Anel de mensagens de produtor único e consumidor único (SPSC) em memória compartilhada.
+// O produtor só escreve 'cauda' e o consumidor só escreve 'cabeca', em linhas de cache separadas;
+// a publicação da cauda com memory_order_release torna a mensagem visível sem nenhuma trava.
+// A capacidade é a potência de 2 que cobre a partição de destino: cada processo envia no máximo uma
+// mensagem por cidade remota a cada superpasso (o menor custo encontrado) e o anel é esvaziado antes do
+// superpasso seguinte, então ele nunca enche.
+typedef struct AnelMensagens {
+    _Alignas(64) atomic_ulong cabeca;   // Próxima posição a ler (escrita só pelo consumidor).
+    _Alignas(64) atomic_ulong cauda;    // Próxima posição a escrever (escrita só pelo produtor).
+    _Alignas(64) unsigned long mascara; // Capacidade - 1.
+    MensagemRelaxacao mensagens[];
+} AnelMensagens;
+
+// Segmento compartilhado de uma partição: as rotas das suas cidades em formato CSR, os custos e
+// predecessores calculados e os anéis pelos quais os outros processos enviam relaxações a ela. Os
+// ponteiros apontam para dentro do próprio segmento, que tem o mesmo endereço em todos os processos.
+typedef struct ParticaoCompartilhada {
+    int inicio, fim;                     // IDs da partição: [inicio, fim).
+    int cidades;                         // Cidades ativas da partição.
+    long rotas;                          // Rotas que partem das cidades da partição.
+    long rotasCortadas;                  // Das quais chegam a cidades de outra partição.
+    size_t* adjacencia;                  // Rotas de inicio + i: posições adjacencia[i] até adjacencia[i + 1] - 1.
+    int* destinos;
+    int* pesos;
+    int* custo;                          // Menor custo até inicio + i (INFINITO: inalcançável).
+    int* pred;                           // Predecessor de inicio + i no caminho mínimo (-1: nenhum).
+    AnelMensagens* aneis[MAX_PARTICOES]; // aneis[q]: mensagens do processo q (NULL para a própria partição).
+} ParticaoCompartilhada;
+
+// Barreira entre processos feita só com atômicos em memória compartilhada. Cada processo lê a fase
+// atual e soma 1 às chegadas; o último a chegar zera as chegadas e avança a fase, o que libera os
+// outros, que esperam a fase mudar. As esperas dentro de uma consulta são curtas, por isso a espera é
+// ativa (com sched_yield); entre consultas os trabalhadores dormem no pipe de comando.
+typedef struct BarreiraParticionada {
+    _Alignas(64) atomic_int chegadas;    // Processos que já chegaram na fase atual.
+    _Alignas(64) atomic_uint fase;       // Número de vezes que a barreira já abriu.
+    int participantes;                   // Número de processos da execução.
+} BarreiraParticionada;
+
+// Segmento de controle, compartilhado por todos os processos da execução.
+typedef struct ControleParticionado {
+    BarreiraParticionada barreira;       // Barreira entre os processos da execução.
+    int origem;                          // Cidade de origem da consulta.
+    int superpassos;                     // Superpassos da última consulta.
+    long* mensagens;                     // mensagens[s * numParticoes + p]: relaxações enviadas por p no superpasso s.
+    long* ativas;                        // ativas[s * numParticoes + p]: cidades de p a expandir no superpasso s.
+    uint8_t dono[MAX_CIDADES];           // Partição dona de cada cidade.
+} ControleParticionado;
+
+// Execução particionada: os segmentos compartilhados, os processos trabalhadores e o estado privado de
+// cada processo (cada um fica com a sua cópia depois do fork).
+typedef struct ExecucaoParticionada {
+    int numParticoes;
+    ControleParticionado* controle;
+    size_t tamanhoControle;
+    ParticaoCompartilhada* particoes[MAX_PARTICOES];
+    size_t tamanhoParticao[MAX_PARTICOES];
+    pid_t processos[MAX_PARTICOES];      // Trabalhadores das partições 1 em diante (a 0 é o próprio chamador).
+    int pipesComando[MAX_PARTICOES];     // Ponta de escrita do pipe de comando de cada trabalhador (só no pai).
+    pid_t pai;                           // No trabalhador, o PID do processo pai (0 no próprio pai).
+    uint32_t geracao;                    // Geração do superpasso atual (como na AreaTrabalho).
+    uint32_t* geracaoEnvio;              // Geração em que cada cidade remota recebeu um custo a enviar.
+    uint32_t* geracaoAtiva;              // Geração em que cada cidade local entrou na próxima fronteira.
+    int* custoEnvio;                     // Menor custo a enviar para cada cidade remota no superpasso.
+    int* predEnvio;                      // Predecessor correspondente a custoEnvio.
+    int* pendentes;                      // Cidades remotas com custo a enviar no superpasso.
+    int* fronteira;                      // Cidades da partição a expandir no superpasso atual.
+    int* proxima;                        // Cidades da partição cujo custo melhorou (próximo superpasso).
+} ExecucaoParticionada;
+
+// Reserva 'bytes' (alinhados a 64) no fim de um segmento de 'tamanho' bytes e retorna a posição reservada.
+static size_t reservarNoSegmento(size_t* tamanho, size_t bytes) {
+    size_t posicao = (*tamanho + 63) & ~(size_t)63;
+    *tamanho = posicao + bytes;
+    return posicao;
+}
+
+// Cria um segmento de memória compartilhada com os processos que forem criados depois (zerado).
+static void* criarSegmentoCompartilhado(size_t tamanho) {
+    void* segmento = mmap(NULL, tamanho, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (segmento == MAP_FAILED) {
+        perror("Erro ao criar a memória compartilhada da execução particionada");
+        exit(EXIT_FAILURE);
+    }
+    return segmento;
+}
+
+// Espera todos os processos da execução chegarem à barreira. Um trabalhador cujo pai morreu no meio
+// da consulta nunca seria liberado, então de tempos em tempos ele confere o pai e, se ele tiver
+// morrido (getppid mudou), encerra.
+static void esperarBarreiraParticionada(const ExecucaoParticionada* exec) {
+    BarreiraParticionada* barreira = &exec->controle->barreira;
+    unsigned fase = atomic_load_explicit(&barreira->fase, memory_order_acquire);
+    if (atomic_fetch_add_explicit(&barreira->chegadas, 1, memory_order_acq_rel) == barreira->participantes - 1) {
+        atomic_store_explicit(&barreira->chegadas, 0, memory_order_relaxed);
+        atomic_store_explicit(&barreira->fase, fase + 1, memory_order_release);
+        return;
+    }
+    for (unsigned esperas = 1; atomic_load_explicit(&barreira->fase, memory_order_acquire) == fase; esperas++) {
+        if (exec->pai != 0 && esperas % ESPERAS_ENTRE_VERIFICACOES_DO_PAI == 0 && getppid() != exec->pai) _exit(EXIT_FAILURE);
+        sched_yield();
+    }
+}
+
+// Envia uma relaxação pelo anel (só o processo produtor chama).
+static inline void enviarMensagemParticao(AnelMensagens* anel, MensagemRelaxacao mensagem) {
+    unsigned long cauda = atomic_load_explicit(&anel->cauda, memory_order_relaxed);
+    // Pelo dimensionamento o anel não enche; se enchesse, espera o consumidor liberar espaço.
+    while (cauda - atomic_load_explicit(&anel->cabeca, memory_order_acquire) > anel->mascara) sched_yield();
+    anel->mensagens[cauda & anel->mascara] = mensagem;
+    atomic_store_explicit(&anel->cauda, cauda + 1, memory_order_release);
+}
+
+// Recebe uma relaxação do anel (só o processo consumidor chama). Retorna false se o anel estiver vazio.
+static inline bool receberMensagemParticao(AnelMensagens* anel, MensagemRelaxacao* mensagem) {
+    unsigned long cabeca = atomic_load_explicit(&anel->cabeca, memory_order_relaxed);
+    if (cabeca == atomic_load_explicit(&anel->cauda, memory_order_acquire)) return false;
+    *mensagem = anel->mensagens[cabeca & anel->mascara];
+    atomic_store_explicit(&anel->cabeca, cabeca + 1, memory_order_release);
+    return true;
+}
+
+// Retorna o menor custo até a cidade 'id' na última consulta particionada (INFINITO se inalcançável).
+static inline int custoParticionado(const ExecucaoParticionada* exec, int id) {
+    const ParticaoCompartilhada* particao = exec->particoes[exec->controle->dono[id]];
+    return particao->custo[id - particao->inicio];
+}
+
+// Retorna o predecessor da cidade 'id' no caminho mínimo da última consulta particionada.
+static inline int predecessorParticionado(const ExecucaoParticionada* exec, int id) {
+    const ParticaoCompartilhada* particao = exec->particoes[exec->controle->dono[id]];
+    return particao->pred[id - particao->inicio];
+}
+
+// Aplica um custo candidato a uma cidade local: se ele melhora o custo atual, atualiza o custo e o
+// predecessor e coloca a cidade (uma única vez) na próxima fronteira.
+static inline void relaxarCidadeLocal(ExecucaoParticionada* exec, ParticaoCompartilhada* particao, int v,
+                                      int custo, int predecessor, int* tamanhoProxima) {
+    int local = v - particao->inicio;
+    if (custo >= particao->custo[local]) return;
+    particao->custo[local] = custo;
+    particao->pred[local] = predecessor;
+    if (exec->geracaoAtiva[v] != exec->geracao) {
+        exec->geracaoAtiva[v] = exec->geracao;
+        exec->proxima[(*tamanhoProxima)++] = v;
+    }
+}
+
+// Executa a parte da consulta que cabe à partição 'p', em sincronia com os outros processos.
+// Cada superpasso tem duas fases separadas por barreiras: na expansão, as rotas das cidades da fronteira
+// são relaxadas (as locais na hora; para cada cidade remota só o menor custo encontrado é enviado ao
+// processo dono); no recebimento, cada processo esvazia os seus anéis. A consulta termina quando nenhum
+// custo melhora em nenhuma partição.
+static void executarMenoresCustosNaParticao(ExecucaoParticionada* exec, int p) {
+    ControleParticionado* controle = exec->controle;
+    ParticaoCompartilhada* particao = exec->particoes[p];
+    int numParticoes = exec->numParticoes;
+    int origem = controle->origem;
+
+    int tamanhoFronteira = 0;
+    for (int i = 0; i < particao->fim - particao->inicio; i++) {
+        particao->custo[i] = INFINITO;
+        particao->pred[i] = -1;
+    }
+    if (origem >= particao->inicio && origem < particao->fim) {
+        particao->custo[origem - particao->inicio] = 0;
+        exec->fronteira[tamanhoFronteira++] = origem;
+    }
+    controle->ativas[p] = tamanhoFronteira;
+    esperarBarreiraParticionada(exec);
+
+    int superpasso = 0;
+    for (;;) {
+        long ativas = 0;
+        for (int q = 0; q < numParticoes; q++) {
+            ativas += controle->ativas[(size_t)superpasso * (size_t)numParticoes + (size_t)q];
+        }
+        if (ativas == 0) break;
+
+        // Fase de expansão. A nova geração esquece em O(1) as marcas do superpasso anterior.
+        if (++exec->geracao == 0) {
+            memset(exec->geracaoEnvio, 0, MAX_CIDADES * sizeof(uint32_t));
+            memset(exec->geracaoAtiva, 0, MAX_CIDADES * sizeof(uint32_t));
+            exec->geracao = 1;
+        }
+        int tamanhoProxima = 0, numPendentes = 0;
+        for (int i = 0; i < tamanhoFronteira; i++) {
+            int u = exec->fronteira[i];
+            int custoU = particao->custo[u - particao->inicio];
+            for (size_t k = particao->adjacencia[u - particao->inicio]; k < particao->adjacencia[u - particao->inicio + 1]; k++) {
+                int v = particao->destinos[k];
+                // Compara sem somar primeiro, para não estourar o int com pesos grandes.
+                if (particao->pesos[k] >= INFINITO - custoU) continue;
+                int custo = custoU + particao->pesos[k];
+                if (controle->dono[v] == p) {
+                    relaxarCidadeLocal(exec, particao, v, custo, u, &tamanhoProxima);
+                } else if (exec->geracaoEnvio[v] != exec->geracao) {
+                    exec->geracaoEnvio[v] = exec->geracao;
+                    exec->custoEnvio[v] = custo;
+                    exec->predEnvio[v] = u;
+                    exec->pendentes[numPendentes++] = v;
+                } else if (custo < exec->custoEnvio[v]) {
+                    exec->custoEnvio[v] = custo;
+                    exec->predEnvio[v] = u;
+                }
+            }
+        }
+        for (int i = 0; i < numPendentes; i++) {
+            int v = exec->pendentes[i];
+            MensagemRelaxacao mensagem = {v, exec->custoEnvio[v], exec->predEnvio[v]};
+            enviarMensagemParticao(exec->particoes[controle->dono[v]]->aneis[p], mensagem);
+        }
+        controle->mensagens[(size_t)superpasso * (size_t)numParticoes + (size_t)p] = numPendentes;
+        esperarBarreiraParticionada(exec);
+
+        // Fase de recebimento: aplica as relaxações enviadas pelas outras partições.
+        for (int q = 0; q < numParticoes; q++) {
+            if (q == p) continue;
+            MensagemRelaxacao mensagem;
+            while (receberMensagemParticao(particao->aneis[q], &mensagem)) {
+                relaxarCidadeLocal(exec, particao, mensagem.cidade, mensagem.custo, mensagem.predecessor, &tamanhoProxima);
+            }
+        }
+        controle->ativas[(size_t)(superpasso + 1) * (size_t)numParticoes + (size_t)p] = tamanhoProxima;
+        int* temporario = exec->fronteira;
+        exec->fronteira = exec->proxima;
+        exec->proxima = temporario;
+        tamanhoFronteira = tamanhoProxima;
+        superpasso++;
+        esperarBarreiraParticionada(exec);
+    }
+    if (p == 0) controle->superpassos = superpasso;
+}
+
+// Laço dos processos trabalhadores: dorme no pipe de comando e executa cada comando recebido. O fim do
+// pipe significa que o pai encerrou a execução ou morreu; em ambos os casos o trabalhador termina.
+static void executarTrabalhadorParticao(ExecucaoParticionada* exec, int p, int pipeComando) {
+    for (;;) {
+        unsigned char comando;
+        ssize_t lidos = read(pipeComando, &comando, 1);
+        if (lidos < 0 && errno == EINTR) continue;
+        if (lidos <= 0) _exit(0);
+        if (comando == COMANDO_PARTICAO_MENORES_CUSTOS) executarMenoresCustosNaParticao(exec, p);
+    }
+}
+
+// Divide o mapa em 'numParticoes' partições e cria um processo trabalhador para cada partição além da
+// primeira (que é atendida pelo próprio chamador). As partições são faixas contíguas de IDs com pesos
+// equilibrados (1 por cidade ativa mais 1 por rota) e recebem uma cópia do mapa no momento da criação:
+// rotas cadastradas depois não aparecem na execução. O resultado pertence ao chamador
+// (liberarExecucaoParticionada encerra os processos).
+ExecucaoParticionada* criarExecucaoParticionada(const MapaCidades* mapa, int numParticoes) {
+    ExecucaoParticionada* exec = (ExecucaoParticionada*)calloc(1, sizeof(ExecucaoParticionada));
+    int* grau = (int*)calloc(MAX_CIDADES, sizeof(int));
+    if (!exec || !grau) {
+        perror("Erro ao alocar memória para a execução particionada");
+        exit(EXIT_FAILURE);
+    }
+    exec->numParticoes = numParticoes;
+
+    // Rotas de cada cidade (só entre cidades ativas) e limites das partições.
+    long pesoTotal = 0;
+    for (int u = 0; u < MAX_CIDADES; u++) {
+        if (!cidadeAtiva(mapa, u)) continue;
+        for (NoRota* rota = mapa->listaRotas[u]; rota != NULL; rota = rota->proximo) {
+            if (cidadeAtiva(mapa, rota->idCidadeDestino)) grau[u]++;
+        }
+        pesoTotal += 1 + grau[u];
+    }
+    int inicioParticao[MAX_PARTICOES + 1];
+    int particao = 0;
+    long acumulado = 0;
+    inicioParticao[0] = 0;
+    for (int u = 0; u < MAX_CIDADES; u++) {
+        // Fecha as partições cuja fatia do peso total já foi preenchida.
+        while (particao < numParticoes - 1 && acumulado >= pesoTotal * (particao + 1) / numParticoes) {
+            inicioParticao[++particao] = u;
+        }
+        if (cidadeAtiva(mapa, u)) acumulado += 1 + grau[u];
+    }
+    while (particao < numParticoes - 1) inicioParticao[++particao] = MAX_CIDADES;
+    inicioParticao[numParticoes] = MAX_CIDADES;
+
+    // Segmento de controle: barreira, dono de cada cidade e contadores por superpasso.
+    size_t tamanho = sizeof(ControleParticionado);
+    size_t tamanhoContadores = (size_t)MAX_SUPERPASSOS_PARTICIONADOS * (size_t)numParticoes * sizeof(long);
+    size_t posicaoMensagens = reservarNoSegmento(&tamanho, tamanhoContadores);
+    size_t posicaoAtivas = reservarNoSegmento(&tamanho, tamanhoContadores);
+    unsigned char* base = (unsigned char*)criarSegmentoCompartilhado(tamanho);
+    ControleParticionado* controle = (ControleParticionado*)base;
+    exec->controle = controle;
+    exec->tamanhoControle = tamanho;
+    controle->mensagens = (long*)(base + posicaoMensagens);
+    controle->ativas = (long*)(base + posicaoAtivas);
+    atomic_init(&controle->barreira.chegadas, 0);
+    atomic_init(&controle->barreira.fase, 0);
+    controle->barreira.participantes = numParticoes;
+    for (int p = 0; p < numParticoes; p++) {
+        for (int u = inicioParticao[p]; u < inicioParticao[p + 1]; u++) controle->dono[u] = (uint8_t)p;
+    }
+
+    // Um segmento por partição, com as rotas em CSR, os custos, os predecessores e os anéis de entrada.
+    for (int p = 0; p < numParticoes; p++) {
+        int inicio = inicioParticao[p], fim = inicioParticao[p + 1];
+        size_t rotas = 0;
+        for (int u = inicio; u < fim; u++) rotas += (size_t)grau[u];
+        unsigned long capacidade = 1;
+        while (capacidade < (unsigned long)(fim - inicio)) capacidade *= 2;
+
+        tamanho = sizeof(ParticaoCompartilhada);
+        size_t posicaoAdjacencia = reservarNoSegmento(&tamanho, (size_t)(fim - inicio + 1) * sizeof(size_t));
+        size_t posicaoDestinos = reservarNoSegmento(&tamanho, rotas * sizeof(int));
+        size_t posicaoPesos = reservarNoSegmento(&tamanho, rotas * sizeof(int));
+        size_t posicaoCusto = reservarNoSegmento(&tamanho, (size_t)(fim - inicio) * sizeof(int));
+        size_t posicaoPred = reservarNoSegmento(&tamanho, (size_t)(fim - inicio) * sizeof(int));
+        size_t posicaoAneis[MAX_PARTICOES];
+        for (int q = 0; q < numParticoes; q++) {
+            if (q != p) posicaoAneis[q] = reservarNoSegmento(&tamanho, sizeof(AnelMensagens) + capacidade * sizeof(MensagemRelaxacao));
+        }
+        base = (unsigned char*)criarSegmentoCompartilhado(tamanho);
+        ParticaoCompartilhada* segmento = (ParticaoCompartilhada*)base;
+        exec->particoes[p] = segmento;
+        exec->tamanhoParticao[p] = tamanho;
+        segmento->inicio = inicio;
+        segmento->fim = fim;
+        segmento->adjacencia = (size_t*)(base + posicaoAdjacencia);
+        segmento->destinos = (int*)(base + posicaoDestinos);
+        segmento->pesos = (int*)(base + posicaoPesos);
+        segmento->custo = (int*)(base + posicaoCusto);
+        segmento->pred = (int*)(base + posicaoPred);
+        for (int q = 0; q < numParticoes; q++) {
+            if (q == p) continue;
+            segmento->aneis[q] = (AnelMensagens*)(base + posicaoAneis[q]);
+            atomic_init(&segmento->aneis[q]->cabeca, 0);
+            atomic_init(&segmento->aneis[q]->cauda, 0);
+            segmento->aneis[q]->mascara = capacidade - 1;
+        }
+
+        // Copia as rotas e mede o corte (rotas que chegam a outra partição).
+        size_t posicao = 0;
+        for (int u = inicio; u < fim; u++) {
+            segmento->adjacencia[u - inicio] = posicao;
+            if (!cidadeAtiva(mapa, u)) continue;
+            segmento->cidades++;
+            for (NoRota* rota = mapa->listaRotas[u]; rota != NULL; rota = rota->proximo) {
+                int v = rota->idCidadeDestino;
+                if (!cidadeAtiva(mapa, v)) continue;
+                segmento->destinos[posicao] = v;
+                segmento->pesos[posicao++] = rota->peso;
+                if (controle->dono[v] != p) segmento->rotasCortadas++;
+            }
+        }
+        segmento->adjacencia[fim - inicio] = posicao;
+        segmento->rotas = (long)posicao;
+    }
+    free(grau);
+
+    // Estado privado (copiado para cada trabalhador no fork).
+    exec->geracaoEnvio = (uint32_t*)calloc(MAX_CIDADES, sizeof(uint32_t));
+    exec->geracaoAtiva = (uint32_t*)calloc(MAX_CIDADES, sizeof(uint32_t));
+    exec->custoEnvio = (int*)malloc(MAX_CIDADES * sizeof(int));
+    exec->predEnvio = (int*)malloc(MAX_CIDADES * sizeof(int));
+    exec->pendentes = (int*)malloc(MAX_CIDADES * sizeof(int));
+    exec->fronteira = (int*)malloc(MAX_CIDADES * sizeof(int));
+    exec->proxima = (int*)malloc(MAX_CIDADES * sizeof(int));
+    if (!exec->geracaoEnvio || !exec->geracaoAtiva || !exec->custoEnvio || !exec->predEnvio ||
+        !exec->pendentes || !exec->fronteira || !exec->proxima) {
+        perror("Erro ao alocar memória para a execução particionada");
+        exit(EXIT_FAILURE);
+    }
+
+    // Cria os trabalhadores das partições 1 em diante, cada um com um pipe de comando cuja ponta de
+    // escrita só o pai mantém aberta: se o pai morrer, o trabalhador recebe o fim do pipe e termina.
+    pid_t pai = getpid();
+    for (int p = 1; p < numParticoes; p++) {
+        int pipeComando[2];
+        if (pipe(pipeComando) < 0) {
+            perror("Erro ao criar o pipe de comando da execução particionada");
+            exit(EXIT_FAILURE);
+        }
+        pid_t processo = fork();
+        if (processo < 0) {
+            perror("Erro ao criar o processo trabalhador da execução particionada");
+            exit(EXIT_FAILURE);
+        }
+        if (processo == 0) {
+            // Fecha as pontas de escrita herdadas (a sua e as dos trabalhadores anteriores).
+            close(pipeComando[1]);
+            for (int q = 1; q < p; q++) close(exec->pipesComando[q]);
+            exec->pai = pai;
+            executarTrabalhadorParticao(exec, p, pipeComando[0]);
+        }
+        close(pipeComando[0]);
+        exec->processos[p] = processo;
+        exec->pipesComando[p] = pipeComando[1];
+    }
+    return exec;
+}
+
+// Passa um comando a todos os trabalhadores (os parâmetros já devem estar no segmento de controle).
+static void enviarComandoParticao(ExecucaoParticionada* exec, unsigned char comando) {
+    for (int p = 1; p < exec->numParticoes; p++) {
+        while (write(exec->pipesComando[p], &comando, 1) != 1) {
+            if (errno != EINTR) {
+                perror("Erro ao enviar comando ao trabalhador da execução particionada");
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+}
+
+// Calcula os menores custos a partir da cidade 'origem' (ID válido e ativo) para todas as cidades, de
+// forma particionada e sem imprimir nada. O chamador atende a partição 0. Custos e predecessores ficam
+// nas partições (custoParticionado, predecessorParticionado) e os contadores de cada superpasso no
+// segmento de controle. Retorna o número de superpassos.
+int menoresCustosParticionados(ExecucaoParticionada* exec, int origem) {
+    exec->controle->origem = origem;
+    enviarComandoParticao(exec, COMANDO_PARTICAO_MENORES_CUSTOS);
+    executarMenoresCustosNaParticao(exec, 0);
+    return exec->controle->superpassos;
+}
+
+// Encerra os processos trabalhadores e libera os segmentos compartilhados e o estado privado.
+void liberarExecucaoParticionada(ExecucaoParticionada* exec) {
+    if (exec == NULL) return;
+    // Fechar os pipes de comando encerra os trabalhadores.
+    for (int p = 1; p < exec->numParticoes; p++) close(exec->pipesComando[p]);
+    for (int p = 1; p < exec->numParticoes; p++) waitpid(exec->processos[p], NULL, 0);
+    for (int p = 0; p < exec->numParticoes; p++) munmap(exec->particoes[p], exec->tamanhoParticao[p]);
+    munmap(exec->controle, exec->tamanhoControle);
+    free(exec->geracaoEnvio);
+    free(exec->geracaoAtiva);
+    free(exec->custoEnvio);
+    free(exec->predEnvio);
+    free(exec->pendentes);
+    free(exec->fronteira);
+    free(exec->proxima);
+    free(exec);
+}
+
+// Função que calcula os menores custos a partir de uma cidade dividindo o mapa em 'numParticoes' processos
+// e mostra as partições com o seu corte, as mensagens trocadas em cada superpasso e o custo e o caminho
+// até cada cidade alcançável.
+void menoresCustosEmParticoes(MapaCidades* mapa, int idOrigem, int numParticoes) {
+    // Validação da origem e do número de processos.
+    if (idOrigem < 0 || idOrigem >= MAX_CIDADES || !cidadeAtiva(mapa, idOrigem)) {
+        printf("Erro: ID de cidade de origem inválido.\n");
+        return;
+    }
+    if (numParticoes < 1 || numParticoes > MAX_PARTICOES) {
+        printf("Erro: o número de processos deve estar entre 1 e %d.\n", MAX_PARTICOES);
+        return;
+    }
+
+    printf("\nCalculando menores custos a partir de %s (ID: %d) em %d processo(s)...\n",
+           nomeCidade(mapa, idOrigem), idOrigem, numParticoes);
+    ExecucaoParticionada* exec = criarExecucaoParticionada(mapa, numParticoes);
+    double inicio = agoraMicrossegundos();
+    int superpassos = menoresCustosParticionados(exec, idOrigem);
+    double tempo = agoraMicrossegundos() - inicio;
+
+    // Partições e corte.
+    long rotas = 0, rotasCortadas = 0;
+    printf("Partições (faixas de IDs equilibradas por cidades + rotas):\n");
+    for (int p = 0; p < numParticoes; p++) {
+        const ParticaoCompartilhada* particao = exec->particoes[p];
+        if (particao->fim > particao->inicio) {
+            printf("  Processo %d: IDs %d a %d, %d cidade(s), %ld rota(s), %ld cortada(s)\n", p,
+                   particao->inicio, particao->fim - 1, particao->cidades, particao->rotas, particao->rotasCortadas);
+        } else {
+            printf("  Processo %d: partição vazia\n", p);
+        }
+        rotas += particao->rotas;
+        rotasCortadas += particao->rotasCortadas;
+    }
+    printf("Corte: %ld de %ld rota(s) (%.1f%%) ligam partições diferentes.\n", rotasCortadas, rotas,
+           rotas > 0 ? 100.0 * (double)rotasCortadas / (double)rotas : 0.0);
+
+    // Volume de mensagens por superpasso.
+    printf("Superpasso | Cidades ativas | Mensagens | Bytes\n");
+    for (int s = 0; s < superpassos; s++) {
+        long ativas = 0, mensagens = 0;
+        for (int p = 0; p < numParticoes; p++) {
+            ativas += exec->controle->ativas[(size_t)s * (size_t)numParticoes + (size_t)p];
+            mensagens += exec->controle->mensagens[(size_t)s * (size_t)numParticoes + (size_t)p];
+        }
+        printf("%10d | %14ld | %9ld | %ld\n", s, ativas, mensagens, mensagens * (long)sizeof(MensagemRelaxacao));
+    }
+
+    // Custos e caminhos (os predecessores são copiados das partições para usar imprimirCaminho).
+    int pred[MAX_CIDADES];
+    for (int i = 0; i < MAX_CIDADES; i++) pred[i] = predecessorParticionado(exec, i);
+    printf("Cidades alcançáveis:\n");
+    for (int i = 0; i < MAX_CIDADES; i++) {
+        int custo = custoParticionado(exec, i);
+        if (custo == INFINITO) continue;
+        printf("  %s (ID: %d) - custo %d: ", nomeCidade(mapa, i), i, custo);
+        imprimirCaminho(mapa, pred, i);
+        printf("\n");
+    }
+    printf("Calculado em %.2f ms em %d superpasso(s).\n", tempo / 1e3, superpassos);
+    liberarExecucaoParticionada(exec);
+}
+
+// Função que libera as listas de rotas de todas as cidades do mapa.
+void liberarListasDeRotas(MapaCidades* mapa) {
     // Itera por todas as cidades.
     for (int i = 0; i < MAX_CIDADES; i++) {
-        if (mapa->cidades[i].ativa) { // Se a cidade estiver ativa.
-            NoRota* atual = mapa->cidades[i].listaRotas; // Ponteiro para o início da lista de rotas.
+        if (cidadeAtiva(mapa, i)) { // Se a cidade estiver ativa.
+            NoRota* atual = mapa->listaRotas[i]; // Ponteiro para o início da lista de rotas.
             // Itera pela lista de rotas, liberando cada nó.
             while (atual != NULL) {
                 NoRota* temp = atual;       // Guarda o nó atual.
                 atual = atual->proximo;     // Avança para o próximo nó.
                 free(temp);                 // Libera o nó guardado.
             }
-            mapa->cidades[i].listaRotas = NULL; // Define a lista de rotas como nula após liberar.
+            mapa->listaRotas[i] = NULL; // Define a lista de rotas como nula após liberar.
         }
     }
+}
+
+// Função para liberar toda a memória alocada dinamicamente para o mapa de cidades.
+// Itera por cada cidade ativa, liberando a memória de cada nó em sua lista de rotas.
+// Por fim, libera a memória da própria estrutura MapaCidades.
+void liberarMapaCidades(MapaCidades* mapa) {
+    if (mapa == NULL) return; // Se o mapa for nulo, não há nada a fazer.
+    liberarListasDeRotas(mapa);
+    liberarTabelaDistancias(mapa->todosOsPares);
     free(mapa); // Libera a estrutura do mapa.
     printf("Memória do mapa de cidades liberada.\n");
 }
 
+// Função que cria uma cópia independente do mapa (estrutura e listas de rotas).
+// É usada como snapshot imutável pelo modo servidor.
+MapaCidades* clonarMapaCidades(const MapaCidades* mapa) {
+    MapaCidades* copia = (MapaCidades*)malloc(sizeof(MapaCidades));
+    if (!copia) {
+        perror("Erro ao alocar memória para a cópia do MapaCidades");
+        exit(EXIT_FAILURE);
+    }
+    // Copia de uma vez os arrays de tamanho fixo (bitmap, nomes, contadores, versão).
+    memcpy(copia, mapa, sizeof(MapaCidades));
+    copia->todosOsPares = NULL; // A tabela de todos os pares pertence ao mapa original.
+    // Copia as listas de rotas, preservando a ordem dos nós.
+    for (int i = 0; i < MAX_CIDADES; i++) {
+        NoRota** destino = &copia->listaRotas[i];
+        for (NoRota* rota = mapa->listaRotas[i]; rota != NULL; rota = rota->proximo) {
+            *destino = criarNoRota(rota->idCidadeDestino, rota->peso);
+            destino = &(*destino)->proximo;
+        }
+        *destino = NULL;
+    }
+    return copia;
+}
+
 // Função para exibir o menu de opções para o usuário.
 void exibirMenuCidades() {
     printf("\n--- Sistema de Rotas Otimizadas entre Cidades ---\n");
@@ -286,6 +1645,9 @@ void exibirMenuCidades() {
     printf("3. Visualizar Cidades e Rotas\n");
     printf("4. Calcular Menor Caminho (Dijkstra)\n");
     printf("5. Listar todas as cidades ativas\n");
+    printf("6. Calcular Área Alcançável (Isócrona)\n");
+    printf("7. Calcular Menores Caminhos entre Todos os Pares\n");
+    printf("8. Calcular Menores Custos em Vários Processos (Particionado)\n");
     printf("0. Sair\n");
     printf("Escolha uma opção: ");
 }
@@ -296,8 +1658,8 @@ void listarCidadesAtivas(MapaCidades* mapa) {
     printf("\n--- Cidades Ativas no Mapa ---\n");
     int count = 0; // Contador de cidades ativas encontradas.
     for (int i = 0; i < MAX_CIDADES; i++) {
-        if (mapa->cidades[i].ativa) { // Se a cidade está ativa.
-            printf("ID: %d, Nome: %s\n", mapa->cidades[i].id, mapa->cidades[i].nome);
+        if (cidadeAtiva(mapa, i)) { // Se a cidade está ativa.
+            printf("ID: %d, Nome: %s\n", i, nomeCidade(mapa, i));
             count++;
         }
     }
@@ -306,11 +1668,735 @@ void listarCidadesAtivas(MapaCidades* mapa) {
     }
 }
 
+// Define a requisição do protocolo binário do servidor (tamanho fixo de 16 bytes).
+typedef struct RequisicaoServidor {
+    uint8_t operacao;         // Código da operação (OP_SERVIDOR_*).
+    uint8_t reservado[3];     // Não usado (alinhamento).
+    int32_t argumentos[3];    // Argumentos da operação (IDs de cidades e peso).
+} RequisicaoServidor;
+
+// Define o cabeçalho da resposta do servidor. Ele é seguido por 'quantidade' inteiros de 32 bits.
+typedef struct CabecalhoResposta {
+    int32_t status;           // STATUS_OK ou um código de erro.
+    uint32_t versao;          // Versão do snapshot que respondeu à consulta (ou criada pela escrita).
+    uint32_t quantidade;      // Número de inteiros int32 que seguem o cabeçalho.
+} CabecalhoResposta;
+
+// Define um item da fila do pool: um cliente e a requisição completa que o laço de eventos recebeu dele.
+typedef struct ClientePronto {
+    int cliente;
+    RequisicaoServidor requisicao;
+} ClientePronto;
+
+// Define o estado do servidor de consultas.
+// Os leitores nunca usam o mapa mutável: eles consultam um snapshot imutável, publicado por troca
+// atômica de ponteiro no estilo RCU. Cada trabalhador anuncia em 'snapshotEmUso' o snapshot que está
+// lendo; o escritor só libera um snapshot antigo depois que nenhum trabalhador o anuncia mais.
+// Assim as escritas nunca bloqueiam consultas em andamento (quem espera é o escritor).
+typedef struct Servidor {
+    MapaCidades* mapa;                                      // Mapa mutável, alterado só sob 'mutexEscrita'.
+    _Atomic(MapaCidades*) snapshotAtual;                    // Snapshot imutável mais recente.
+    _Atomic(MapaCidades*) snapshotEmUso[NUM_TRABALHADORES]; // Snapshot lido por cada trabalhador (NULL: nenhum).
+    pthread_mutex_t mutexEscrita;                           // Serializa os cadastros de rotas e a publicação de snapshots.
+    pthread_mutex_t mutexFila;                              // Protege a fila de clientes prontos.
+    pthread_cond_t condicaoFila;                            // Sinaliza clientes novos na fila.
+    ClientePronto filaClientes[MAX_CLIENTES];               // Fila circular de clientes com requisição completa.
+    int inicioFila, tamanhoFila;
+    int pipeDevolucao[2];                                   // Trabalhadores devolvem por aqui os clientes atendidos.
+    bool encerrando;                                        // Indica aos trabalhadores que o servidor está parando.
+    // Estatísticas das consultas de cada trabalhador (só com "--estatisticas"; somadas no encerramento).
+    AgregadoEstatisticas estatisticas[NUM_TRABALHADORES][NUM_OPERACOES_ESTATISTICAS];
+} Servidor;
+
+// Define os argumentos de cada thread trabalhadora.
+typedef struct ArgumentoTrabalhador {
+    Servidor* servidor;
+    int indice;               // Índice do trabalhador (posição em 'snapshotEmUso').
+} ArgumentoTrabalhador;
+
+// Sinalizado por SIGINT/SIGTERM para encerrar o laço de eventos.
+static volatile sig_atomic_t servidorDeveEncerrar = 0;
+
+// Função de tratamento de sinais do modo servidor: apenas pede o encerramento.
+void tratarSinalServidor(int sinal) {
+    (void)sinal;
+    servidorDeveEncerrar = 1;
+}
+
+// Função que escreve exatamente 'tamanho' bytes em um socket não bloqueante. Quando o socket enche,
+// espera (poll) que ele volte a aceitar dados, mas no máximo TEMPO_LIMITE_ESCRITA_MS no total: um
+// cliente que parou de ler não prende o trabalhador nem o encerramento do servidor.
+// Retorna false em caso de erro ou de tempo esgotado.
+bool escreverCompleto(int descritor, const void* origem, size_t tamanho) {
+    size_t escritos = 0;
+    double limite = agoraMicrossegundos() + TEMPO_LIMITE_ESCRITA_MS * 1000.0;
+    while (escritos < tamanho) {
+        ssize_t n = write(descritor, (const char*)origem + escritos, tamanho - escritos);
+        if (n > 0) {
+            escritos += (size_t)n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) return false;
+        int restante = (int)((limite - agoraMicrossegundos()) / 1000.0);
+        struct pollfd espera = {descritor, POLLOUT, 0};
+        if (restante <= 0 || poll(&espera, 1, restante) <= 0) return false;
+    }
+    return true;
+}
+
+// Função que coloca um descritor em modo não bloqueante. Retorna false em caso de erro.
+bool tornarNaoBloqueante(int descritor) {
+    int flags = fcntl(descritor, F_GETFL, 0);
+    return flags >= 0 && fcntl(descritor, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+// Função que obtém o snapshot atual para leitura pelo trabalhador 'indice'.
+// O anúncio em 'snapshotEmUso' é confirmado relendo 'snapshotAtual': se uma troca ocorreu no meio,
+// tenta de novo, garantindo que o escritor sempre enxergue o anúncio antes de liberar o snapshot.
+MapaCidades* adquirirSnapshot(Servidor* servidor, int indice) {
+    MapaCidades* snapshot;
+    do {
+        snapshot = atomic_load(&servidor->snapshotAtual);
+        atomic_store(&servidor->snapshotEmUso[indice], snapshot);
+    } while (snapshot != atomic_load(&servidor->snapshotAtual));
+    return snapshot;
+}
+
+// Função que encerra a leitura do trabalhador 'indice' (o snapshot pode ser liberado pelo escritor).
+void soltarSnapshot(Servidor* servidor, int indice) {
+    atomic_store(&servidor->snapshotEmUso[indice], NULL);
+}
+
+// Função que publica um novo snapshot do mapa mutável (chamada pelo escritor, sob 'mutexEscrita').
+// Retorna o snapshot antigo, que o escritor libera com liberarSnapshotAntigo depois de soltar a trava.
+MapaCidades* publicarSnapshot(Servidor* servidor) {
+    MapaCidades* novo = clonarMapaCidades(servidor->mapa);
+    return atomic_exchange(&servidor->snapshotAtual, novo);
+}
+
+// Função que espera os leitores que ainda usam um snapshot já substituído terminarem e o libera.
+// É chamada fora de 'mutexEscrita', para que o período de carência não atrase as outras escritas.
+void liberarSnapshotAntigo(Servidor* servidor, MapaCidades* antigo) {
+    for (int i = 0; i < NUM_TRABALHADORES; i++) {
+        while (atomic_load(&servidor->snapshotEmUso[i]) == antigo) {
+            sched_yield(); // Período de carência: aguarda o leitor terminar a consulta.
+        }
+    }
+    liberarListasDeRotas(antigo);
+    free(antigo);
+}
+
+// Função que verifica se um ID recebido pelo servidor é válido e ativo no mapa fornecido.
+bool idCidadeValido(const MapaCidades* mapa, int32_t id) {
+    return id >= 0 && id < MAX_CIDADES && cidadeAtiva(mapa, id);
+}
+
+// Função que executa uma requisição e envia a resposta ao cliente.
+// 'dados' é o buffer de resposta do trabalhador (espaço para 2 * MAX_CIDADES + 1 inteiros); as buscas
+// usam a área de trabalho da thread do trabalhador.
+// Retorna false se a resposta não pôde ser enviada.
+bool atenderRequisicao(Servidor* servidor, int indice, const RequisicaoServidor* requisicao,
+                       int cliente, int32_t* dados) {
+    AreaTrabalho* area = areaTrabalhoDaThread();
+    CabecalhoResposta cabecalho = {STATUS_OK, 0, 0};
+    int32_t origem = requisicao->argumentos[0], destino = requisicao->argumentos[1];
+
+    if (requisicao->operacao == OP_SERVIDOR_CADASTRAR_ROTA) {
+        // Escrita: altera o mapa mutável e publica um novo snapshot. A seção crítica só altera o mapa
+        // e troca o snapshot (inserirRota não imprime nada); o antigo é liberado depois da trava.
+        MapaCidades* antigo = NULL;
+        pthread_mutex_lock(&servidor->mutexEscrita);
+        if (inserirRota(servidor->mapa, origem, destino, requisicao->argumentos[2]) != ROTA_CADASTRADA) {
+            cabecalho.status = STATUS_ARGUMENTO_INVALIDO;
+        } else {
+            antigo = publicarSnapshot(servidor);
+        }
+        cabecalho.versao = (uint32_t)servidor->mapa->versao;
+        pthread_mutex_unlock(&servidor->mutexEscrita);
+        if (antigo != NULL) liberarSnapshotAntigo(servidor, antigo);
+    } else if (requisicao->operacao == OP_SERVIDOR_DIJKSTRA) {
+        // Leitura: consulta o snapshot imutável atual, sem nenhum bloqueio.
+        const MapaCidades* snapshot = adquirirSnapshot(servidor, indice);
+        cabecalho.versao = (uint32_t)snapshot->versao;
+        if (!idCidadeValido(snapshot, origem) || !idCidadeValido(snapshot, destino)) {
+            cabecalho.status = STATUS_ARGUMENTO_INVALIDO;
+        } else {
+            EstatisticasConsulta estatisticas;
+            int custo = calcularMenorCaminho(snapshot, origem, destino, area, estatisticasAtivas ? &estatisticas : NULL);
+            if (estatisticasAtivas) acumularEstatisticas(&servidor->estatisticas[indice][ESTATISTICAS_DIJKSTRA], &estatisticas);
+            dados[0] = custo == INFINITO ? -1 : custo; // -1 indica que não há caminho.
+            cabecalho.quantidade = 1;
+            if (custo != INFINITO) {
+                // Conta as cidades do caminho e as escreve da origem para o destino.
+                int tamanhoCaminho = 0;
+                for (int v = destino; v != -1; v = area->pred[v]) tamanhoCaminho++;
+                int posicao = tamanhoCaminho;
+                for (int v = destino; v != -1; v = area->pred[v]) dados[posicao--] = v;
+                cabecalho.quantidade += (uint32_t)tamanhoCaminho;
+            }
+        }
+        soltarSnapshot(servidor, indice);
+    } else if (requisicao->operacao == OP_SERVIDOR_ISOCRONA) {
+        // Leitura: consulta o snapshot imutável atual, sem nenhum bloqueio.
+        const MapaCidades* snapshot = adquirirSnapshot(servidor, indice);
+        cabecalho.versao = (uint32_t)snapshot->versao;
+        int32_t limite = requisicao->argumentos[1];
+        if (!idCidadeValido(snapshot, origem) || limite < 0) {
+            cabecalho.status = STATUS_ARGUMENTO_INVALIDO;
+        } else {
+            int origens[1] = {origem};
+            int alcancadas[MAX_CIDADES], custos[MAX_CIDADES];
+            EstatisticasConsulta estatisticas;
+            int total = calcularIsocrona(snapshot, origens, 1, limite, area, alcancadas, custos,
+                                         estatisticasAtivas ? &estatisticas : NULL);
+            if (estatisticasAtivas) acumularEstatisticas(&servidor->estatisticas[indice][ESTATISTICAS_ISOCRONA], &estatisticas);
+            for (int i = 0; i < total; i++) {
+                dados[2 * i] = alcancadas[i];
+                dados[2 * i + 1] = custos[i];
+            }
+            cabecalho.quantidade = (uint32_t)(2 * total);
+        }
+        soltarSnapshot(servidor, indice);
+    } else {
+        cabecalho.status = STATUS_OPERACAO_DESCONHECIDA;
+    }
+
+    return escreverCompleto(cliente, &cabecalho, sizeof(cabecalho)) &&
+           escreverCompleto(cliente, dados, cabecalho.quantidade * sizeof(int32_t));
+}
+
+// Função executada por cada thread trabalhadora: retira da fila os clientes com uma requisição completa,
+// atende-a e os devolve ao laço de eventos pelo pipe (o ID negativo -1 - cliente indica que a
+// conexão deve ser fechada). O trabalhador nunca lê do socket, então um cliente lento não o prende.
+void* executarTrabalhador(void* argumento) {
+    ArgumentoTrabalhador* arg = (ArgumentoTrabalhador*)argumento;
+    Servidor* servidor = arg->servidor;
+    int32_t* dados = (int32_t*)malloc((2 * MAX_CIDADES + 1) * sizeof(int32_t));
+    if (!dados) {
+        perror("Erro ao alocar memória para o buffer de resposta");
+        exit(EXIT_FAILURE);
+    }
+    for (;;) {
+        // Aguarda um cliente com requisição pendente.
+        pthread_mutex_lock(&servidor->mutexFila);
+        while (servidor->tamanhoFila == 0 && !servidor->encerrando) {
+            pthread_cond_wait(&servidor->condicaoFila, &servidor->mutexFila);
+        }
+        if (servidor->tamanhoFila == 0) { // Encerrando e sem trabalho pendente.
+            pthread_mutex_unlock(&servidor->mutexFila);
+            break;
+        }
+        ClientePronto pronto = servidor->filaClientes[servidor->inicioFila];
+        servidor->inicioFila = (servidor->inicioFila + 1) % MAX_CLIENTES;
+        servidor->tamanhoFila--;
+        pthread_mutex_unlock(&servidor->mutexFila);
+
+        // Atende a requisição; uma falha ao enviar a resposta (ou tempo esgotado) encerra o cliente.
+        bool ok = atenderRequisicao(servidor, arg->indice, &pronto.requisicao, pronto.cliente, dados);
+        int devolucao = ok ? pronto.cliente : -1 - pronto.cliente;
+        if (write(servidor->pipeDevolucao[1], &devolucao, sizeof(devolucao)) != sizeof(devolucao)) {
+            perror("Erro ao devolver cliente ao laço de eventos");
+        }
+    }
+    free(dados);
+    return NULL;
+}
+
+// Função que executa o sistema de rotas como servidor de consultas em um socket de domínio Unix.
+// O laço de eventos (poll) aceita conexões e lê as requisições dos sockets não bloqueantes, guardando
+// os bytes de cada cliente até completar os 16 da requisição; só então o cliente sai do conjunto
+// monitorado e vai, com a requisição, para a fila do pool de trabalhadores, que a atende e o devolve.
+// Assim cada cliente tem no máximo uma requisição em andamento e as respostas saem em ordem, e um
+// cliente que envia só parte de uma requisição não ocupa nenhum trabalhador.
+// Encerra com SIGINT ou SIGTERM.
+void executarServidor(MapaCidades* mapa, const char* caminhoSocket) {
+    Servidor* servidor = (Servidor*)malloc(sizeof(Servidor));
+    if (!servidor) {
+        perror("Erro ao alocar memória para o servidor");
+        exit(EXIT_FAILURE);
+    }
+    servidor->mapa = mapa;
+    atomic_init(&servidor->snapshotAtual, clonarMapaCidades(mapa));
+    for (int i = 0; i < NUM_TRABALHADORES; i++) atomic_init(&servidor->snapshotEmUso[i], NULL);
+    pthread_mutex_init(&servidor->mutexEscrita, NULL);
+    pthread_mutex_init(&servidor->mutexFila, NULL);
+    pthread_cond_init(&servidor->condicaoFila, NULL);
+    servidor->inicioFila = 0;
+    servidor->tamanhoFila = 0;
+    servidor->encerrando = false;
+    memset(servidor->estatisticas, 0, sizeof(servidor->estatisticas));
+
+    // Cria o socket de escuta.
+    struct sockaddr_un endereco;
+    memset(&endereco, 0, sizeof(endereco));
+    endereco.sun_family = AF_UNIX;
+    if (strlen(caminhoSocket) >= sizeof(endereco.sun_path)) {
+        printf("Erro: caminho do socket muito longo.\n");
+        free(servidor);
+        return;
+    }
+    strcpy(endereco.sun_path, caminhoSocket);
+    int escuta = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(caminhoSocket); // Remove um socket antigo que tenha sobrado de outra execução.
+    if (escuta < 0 || bind(escuta, (struct sockaddr*)&endereco, sizeof(endereco)) != 0 ||
+        listen(escuta, MAX_CLIENTES) != 0 || !tornarNaoBloqueante(escuta) || pipe(servidor->pipeDevolucao) != 0) {
+        perror("Erro ao iniciar o servidor");
+        exit(EXIT_FAILURE);
+    }
+
+    // Trata os sinais: SIGINT/SIGTERM encerram; SIGPIPE (cliente que desconectou) é ignorado.
+    struct sigaction acao;
+    memset(&acao, 0, sizeof(acao));
+    acao.sa_handler = tratarSinalServidor;
+    sigaction(SIGINT, &acao, NULL);
+    sigaction(SIGTERM, &acao, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    // Inicia o pool de trabalhadores.
+    pthread_t threads[NUM_TRABALHADORES];
+    ArgumentoTrabalhador argumentos[NUM_TRABALHADORES];
+    for (int i = 0; i < NUM_TRABALHADORES; i++) {
+        argumentos[i].servidor = servidor;
+        argumentos[i].indice = i;
+        pthread_create(&threads[i], NULL, executarTrabalhador, &argumentos[i]);
+    }
+    printf("Servidor de rotas aguardando consultas em %s (versão %lu).\n", caminhoSocket, mapa->versao);
+    fflush(stdout);
+
+    // Clientes conectados; 'ocupado' indica que o cliente está com um trabalhador (fora do poll) e
+    // 'recebido' guarda os bytes já lidos da próxima requisição.
+    int clientes[MAX_CLIENTES];
+    bool ocupado[MAX_CLIENTES];
+    unsigned char recebido[MAX_CLIENTES][sizeof(RequisicaoServidor)];
+    size_t bytesRecebidos[MAX_CLIENTES];
+    int numClientes = 0;
+    struct pollfd monitorados[2 + MAX_CLIENTES];
+    int indiceDoMonitorado[2 + MAX_CLIENTES];
+
+    // Laço de eventos.
+    while (!servidorDeveEncerrar) {
+        // Monta o conjunto monitorado: socket de escuta, pipe de devolução e clientes ociosos.
+        int total = 0;
+        monitorados[total].fd = escuta;
+        monitorados[total++].events = numClientes < MAX_CLIENTES ? POLLIN : 0;
+        monitorados[total].fd = servidor->pipeDevolucao[0];
+        monitorados[total++].events = POLLIN;
+        for (int i = 0; i < numClientes; i++) {
+            if (ocupado[i]) continue;
+            monitorados[total].fd = clientes[i];
+            monitorados[total].events = POLLIN;
+            indiceDoMonitorado[total++] = i;
+        }
+        // Usa um tempo limite para verificar periodicamente o pedido de encerramento.
+        if (poll(monitorados, (nfds_t)total, 500) <= 0) continue;
+
+        // Lê o que os clientes ociosos enviaram; quem completou uma requisição vai para a fila dos
+        // trabalhadores e quem desconectou é fechado. Percorre de trás para frente porque fechar um
+        // cliente move o último para a sua posição, e os de índice maior já foram tratados.
+        for (int m = total - 1; m >= 2; m--) {
+            if (monitorados[m].revents == 0) continue;
+            int i = indiceDoMonitorado[m];
+            ssize_t n = read(clientes[i], recebido[i] + bytesRecebidos[i], sizeof(RequisicaoServidor) - bytesRecebidos[i]);
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) continue;
+            if (n <= 0) {
+                close(clientes[i]);
+                numClientes--;
+                clientes[i] = clientes[numClientes];
+                ocupado[i] = ocupado[numClientes];
+                memcpy(recebido[i], recebido[numClientes], sizeof(RequisicaoServidor));
+                bytesRecebidos[i] = bytesRecebidos[numClientes];
+                continue;
+            }
+            bytesRecebidos[i] += (size_t)n;
+            if (bytesRecebidos[i] < sizeof(RequisicaoServidor)) continue;
+            ClientePronto pronto;
+            pronto.cliente = clientes[i];
+            memcpy(&pronto.requisicao, recebido[i], sizeof(RequisicaoServidor));
+            bytesRecebidos[i] = 0;
+            ocupado[i] = true;
+            pthread_mutex_lock(&servidor->mutexFila);
+            servidor->filaClientes[(servidor->inicioFila + servidor->tamanhoFila) % MAX_CLIENTES] = pronto;
+            servidor->tamanhoFila++;
+            pthread_cond_signal(&servidor->condicaoFila);
+            pthread_mutex_unlock(&servidor->mutexFila);
+        }
+        // Clientes devolvidos pelos trabalhadores voltam a ser monitorados (ou são fechados).
+        if (monitorados[1].revents & POLLIN) {
+            int devolucao;
+            if (read(servidor->pipeDevolucao[0], &devolucao, sizeof(devolucao)) == sizeof(devolucao)) {
+                int cliente = devolucao >= 0 ? devolucao : -1 - devolucao;
+                for (int i = 0; i < numClientes; i++) {
+                    if (clientes[i] != cliente) continue;
+                    if (devolucao >= 0) {
+                        ocupado[i] = false;
+                    } else {
+                        close(cliente);
+                        numClientes--;
+                        clientes[i] = clientes[numClientes];
+                        ocupado[i] = ocupado[numClientes];
+                        memcpy(recebido[i], recebido[numClientes], sizeof(RequisicaoServidor));
+                        bytesRecebidos[i] = bytesRecebidos[numClientes];
+                    }
+                    break;
+                }
+            }
+        }
+        // Aceita uma nova conexão.
+        if (monitorados[0].revents & POLLIN) {
+            int cliente = accept(escuta, NULL, NULL);
+            if (cliente >= 0 && !tornarNaoBloqueante(cliente)) {
+                close(cliente);
+            } else if (cliente >= 0) {
+                clientes[numClientes] = cliente;
+                ocupado[numClientes] = false;
+                bytesRecebidos[numClientes++] = 0;
+            }
+        }
+    }
+
+    // Encerramento: para os trabalhadores, fecha as conexões e libera o snapshot publicado.
+    printf("\nEncerrando o servidor...\n");
+    pthread_mutex_lock(&servidor->mutexFila);
+    servidor->encerrando = true;
+    pthread_cond_broadcast(&servidor->condicaoFila);
+    pthread_mutex_unlock(&servidor->mutexFila);
+    for (int i = 0; i < NUM_TRABALHADORES; i++) pthread_join(threads[i], NULL);
+    for (int i = 0; i < numClientes; i++) close(clientes[i]);
+    close(escuta);
+    close(servidor->pipeDevolucao[0]);
+    close(servidor->pipeDevolucao[1]);
+    unlink(caminhoSocket);
+    if (estatisticasAtivas) {
+        // Junta as estatísticas de todos os trabalhadores no primeiro e as relata.
+        for (int i = 1; i < NUM_TRABALHADORES; i++) {
+            for (int op = 0; op < NUM_OPERACOES_ESTATISTICAS; op++) {
+                combinarAgregados(&servidor->estatisticas[0][op], &servidor->estatisticas[i][op]);
+            }
+        }
+        imprimirHistogramas(stdout, servidor->estatisticas[0]);
+    }
+    MapaCidades* snapshot = atomic_load(&servidor->snapshotAtual);
+    liberarListasDeRotas(snapshot);
+    free(snapshot);
+    pthread_mutex_destroy(&servidor->mutexEscrita);
+    pthread_mutex_destroy(&servidor->mutexFila);
+    pthread_cond_destroy(&servidor->condicaoFila);
+    free(servidor);
+}
+
+
+// Tipos de mapa sintético gerados pelo modo benchmark.
+#define MAPA_GRADE 0          // Malha viária em grade, com rotas nos dois sentidos entre vizinhos.
+#define MAPA_GEOMETRICO 1     // Grafo geométrico aleatório: cidades próximas ligadas, peso = distância.
+
+// Nomes dos tipos de mapa no arquivo de resultados.
+static const char* const nomesMapasBenchmark[] = {"grade", "geometrico"};
+
+// Operações medidas pelo modo benchmark.
+#define BENCH_DIJKSTRA 0             // Menor caminho entre um par aleatório de cidades.
+#define BENCH_ISOCRONA 1             // Isócrona de custo LIMITE_ISOCRONA_BENCHMARK a partir de uma cidade aleatória.
+#define BENCH_DIJKSTRA_TABELA 2      // Menor caminho respondido pela tabela de todos os pares.
+#define NUM_OPERACOES_BENCHMARK 3
+
+// Nomes das operações no arquivo de resultados.
+static const char* const nomesOperacoesBenchmark[NUM_OPERACOES_BENCHMARK] = {"dijkstra", "isocrona", "dijkstra_tabela"};
+
+// Tarefa de uma thread do benchmark: executa 'consultas' consultas da operação sobre o mapa
+// (somente leitura) e registra a latência de cada uma, em microssegundos.
+typedef struct TarefaBenchmark {
+    const MapaCidades* mapa;
+    int operacao;             // BENCH_*.
+    int numCidades;           // As cidades geradas ocupam os IDs 0..numCidades-1.
+    int consultas;            // Quantidade de consultas desta thread.
+    uint64_t semente;         // Semente do gerador pseudoaleatório desta thread.
+    double* latencias;        // Saída: latência de cada consulta.
+} TarefaBenchmark;
+
+// Gerador pseudoaleatório splitmix64: rápido, determinístico e sem estado global (seguro entre threads).
+uint64_t proximoAleatorio(uint64_t* estado) {
+    uint64_t z = (*estado += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Retorna a raiz quadrada inteira (arredondada para baixo) de um número não negativo (método de Newton).
+long raizInteira(long n) {
+    if (n < 2) return n;
+    long x = n, y = (x + 1) / 2;
+    while (y < x) {
+        x = y;
+        y = (x + n / x) / 2;
+    }
+    return x;
+}
+
+// Gera um mapa sintético com 'numCidades' cidades do tipo indicado (MAPA_GRADE ou MAPA_GEOMETRICO),
+// usando as funções internas (sem impressão). Retorna o número de rotas criadas.
+long gerarMapaSintetico(MapaCidades* mapa, int tipo, int numCidades, uint64_t semente) {
+    char nome[MAX_NOME_CIDADE];
+    for (int i = 0; i < numCidades; i++) {
+        int tamanhoNome = snprintf(nome, sizeof(nome), "C%d", i);
+        ativarCidade(mapa, i, nome, tamanhoNome);
+    }
+    long rotas = 0;
+    if (tipo == MAPA_GRADE) {
+        // Grade lado x lado: cada cidade liga-se à vizinha da direita e à de baixo, nos dois sentidos,
+        // com pesos aleatórios entre 1 e 100 (trechos de estrada de comprimentos diferentes).
+        int lado = (int)raizInteira(numCidades);
+        for (int i = 0; i < lado * lado; i++) {
+            int linha = i / lado, coluna = i % lado;
+            if (coluna + 1 < lado) {
+                int peso = 1 + (int)(proximoAleatorio(&semente) % 100);
+                adicionarRotaNaLista(mapa, i, i + 1, peso);
+                adicionarRotaNaLista(mapa, i + 1, i, peso);
+                rotas += 2;
+            }
+            if (linha + 1 < lado) {
+                int peso = 1 + (int)(proximoAleatorio(&semente) % 100);
+                adicionarRotaNaLista(mapa, i, i + lado, peso);
+                adicionarRotaNaLista(mapa, i + lado, i, peso);
+                rotas += 2;
+            }
+        }
+    } else {
+        // Grafo geométrico: cidades em posições aleatórias de um quadrado 10000 x 10000, ligadas quando a
+        // distância é menor que um raio escolhido para dar grau médio próximo de 6 (6 = pi * r² * n / área).
+        long* x = (long*)malloc((size_t)numCidades * sizeof(long));
+        long* y = (long*)malloc((size_t)numCidades * sizeof(long));
+        if (!x || !y) {
+            perror("Erro ao alocar memória para o gerador de mapas");
+            exit(EXIT_FAILURE);
+        }
+        for (int i = 0; i < numCidades; i++) {
+            x[i] = (long)(proximoAleatorio(&semente) % 10000);
+            y[i] = (long)(proximoAleatorio(&semente) % 10000);
+        }
+        long raioAoQuadrado = 6L * 10000 * 10000 / (314L * numCidades / 100);
+        for (int i = 0; i < numCidades; i++) {
+            for (int j = i + 1; j < numCidades; j++) {
+                long dx = x[i] - x[j], dy = y[i] - y[j];
+                long distanciaAoQuadrado = dx * dx + dy * dy;
+                if (distanciaAoQuadrado > raioAoQuadrado) continue;
+                int peso = (int)raizInteira(distanciaAoQuadrado) + 1;
+                adicionarRotaNaLista(mapa, i, j, peso);
+                adicionarRotaNaLista(mapa, j, i, peso);
+                rotas += 2;
+            }
+        }
+        free(x);
+        free(y);
+    }
+    return rotas;
+}
+
+// Confere a tabela de todos os pares (válida para o mapa) contra o Dijkstra em 'consultas' pares aleatórios
+// entre as cidades 0 a numCidades - 1: os custos devem ser iguais e o caminho da tabela deve somar o custo.
+// Retorna o número de divergências. Desliga a tabela durante cada Dijkstra, então não pode rodar em
+// paralelo com outras consultas ao mesmo mapa.
+int verificarTabelaTodosOsPares(MapaCidades* mapa, int numCidades, int consultas, uint64_t semente) {
+    TabelaDistancias* tabela = mapa->todosOsPares;
+    AreaTrabalho* area = areaTrabalhoDaThread();
+    int divergencias = 0;
+    for (int q = 0; q < consultas; q++) {
+        int origem = (int)(proximoAleatorio(&semente) % (uint64_t)numCidades);
+        int destino = (int)(proximoAleatorio(&semente) % (uint64_t)numCidades);
+        int custoTabela = calcularMenorCaminho(mapa, origem, destino, area, NULL);
+        // Soma as rotas do caminho devolvido (a mais barata entre cada par de cidades consecutivas).
+        int64_t somaCaminho = 0;
+        for (int v = destino; custoTabela != INFINITO && v != origem; v = area->pred[v]) {
+            int menorPeso = INFINITO;
+            for (NoRota* rota = mapa->listaRotas[area->pred[v]]; rota != NULL; rota = rota->proximo) {
+                if (rota->idCidadeDestino == v && rota->peso < menorPeso) menorPeso = rota->peso;
+            }
+            somaCaminho += menorPeso;
+        }
+        mapa->todosOsPares = NULL;
+        int custoDijkstra = calcularMenorCaminho(mapa, origem, destino, area, NULL);
+        mapa->todosOsPares = tabela;
+        if (custoTabela != custoDijkstra || (custoTabela != INFINITO && somaCaminho != custoTabela)) divergencias++;
+    }
+    return divergencias;
+}
+
+// Confere a tabela de todos os pares em uma grade com pesos grandes (até 10^9, mais uma rota direta de
+// 1,5 * 10^9), em que muitos caminhos passam de INFINITO_TABELA, e imprime o resultado.
+void verificarTabelaComPesosGrandes() {
+    MapaCidades* mapa = criarMapaCidades();
+    int numCidades = MAX_CIDADES < 64 ? MAX_CIDADES : 64;
+    gerarMapaSintetico(mapa, MAPA_GRADE, numCidades, 5);
+    for (int u = 0; u < numCidades; u++) {
+        for (NoRota* rota = mapa->listaRotas[u]; rota != NULL; rota = rota->proximo) rota->peso *= 10000000;
+    }
+    adicionarRotaNaLista(mapa, 0, numCidades - 1, 1500000000);
+    mapa->todosOsPares = calcularTodosOsPares(mapa);
+    int consultas = numCidades * numCidades;
+    int divergencias = verificarTabelaTodosOsPares(mapa, numCidades, consultas, 17);
+    printf("Tabela de todos os pares com pesos grandes: %d divergência(s) do Dijkstra em %d consultas.\n",
+           divergencias, consultas);
+    liberarMapaCidades(mapa);
+}
+
+// Função executada por cada thread do benchmark: consultas da operação a partir de cidades aleatórias.
+void* executarTarefaBenchmark(void* argumento) {
+    TarefaBenchmark* tarefa = (TarefaBenchmark*)argumento;
+    // Área de trabalho da thread e buffers de saída, alocados uma vez (fora da medição).
+    AreaTrabalho* area = areaTrabalhoDaThread();
+    int* alcancadas = (int*)malloc(MAX_CIDADES * sizeof(int));
+    int* custos = (int*)malloc(MAX_CIDADES * sizeof(int));
+    if (!alcancadas || !custos) {
+        perror("Erro ao alocar memória para o benchmark");
+        exit(EXIT_FAILURE);
+    }
+    volatile long resultado = 0; // Consome os resultados para que as consultas não sejam eliminadas.
+    for (int q = 0; q < tarefa->consultas; q++) {
+        int origem = (int)(proximoAleatorio(&tarefa->semente) % (uint64_t)tarefa->numCidades);
+        int destino = (int)(proximoAleatorio(&tarefa->semente) % (uint64_t)tarefa->numCidades);
+        double inicio = agoraMicrossegundos();
+        if (tarefa->operacao == BENCH_DIJKSTRA || tarefa->operacao == BENCH_DIJKSTRA_TABELA) {
+            // Com a tabela de todos os pares calculada, calcularMenorCaminho responde por consulta a ela.
+            resultado += calcularMenorCaminho(tarefa->mapa, origem, destino, area, NULL);
+        } else {
+            resultado += calcularIsocrona(tarefa->mapa, &origem, 1, LIMITE_ISOCRONA_BENCHMARK, area, alcancadas, custos, NULL);
+        }
+        tarefa->latencias[q] = agoraMicrossegundos() - inicio;
+    }
+    free(alcancadas);
+    free(custos);
+    return NULL;
+}
+
+// Função de comparação de doubles para qsort.
+int compararDoubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Retorna o percentil 'p' (0-100) de um array de latências já ordenado (método do posto mais próximo).
+double percentil(const double* ordenadas, int quantidade, double p) {
+    int posto = (int)(p / 100.0 * quantidade + 0.999999);
+    if (posto < 1) posto = 1;
+    if (posto > quantidade) posto = quantidade;
+    return ordenadas[posto - 1];
+}
+
+// Escreve uma linha de resultados no arquivo CSV: vazão (consultas/s) e percentis de latência (µs).
+void escreverResultadoBenchmark(FILE* saida, const char* mapa, const char* operacao, int vertices, long arestas,
+                                int threads, double* latencias, int quantidade, double tempoTotal) {
+    qsort(latencias, (size_t)quantidade, sizeof(double), compararDoubles);
+    fprintf(saida, "cities_routes,%s:%s,%d,%ld,%d,%d,%.1f,%.2f,%.2f,%.2f,%.2f\n",
+            mapa, operacao, vertices, arestas, threads, quantidade, quantidade / (tempoTotal / 1e6),
+            percentil(latencias, quantidade, 50), percentil(latencias, quantidade, 90),
+            percentil(latencias, quantidade, 99), latencias[quantidade - 1]);
+    fflush(saida);
+}
+
+// Função do modo benchmark: para cada tipo de mapa e cada tamanho (potências de 4 até MAX_CIDADES),
+// gera o mapa, mede a construção e mede cada operação com 1, 2, 4 e 8 threads consultando o mesmo mapa.
+// Nos mapas de até MAX_CIDADES_APSP_BENCHMARK cidades mede também a tabela de todos os pares.
+// Os resultados são gravados em CSV (uma linha por mapa/operação/tamanho/threads), no mesmo formato
+// do benchmark da rede social. Para mapas maiores, compile com -DMAX_CIDADES=<n> (por exemplo, 4096).
+void executarBenchmark(const char* caminhoSaida) {
+    FILE* saida = fopen(caminhoSaida, "w");
+    if (saida == NULL) {
+        perror("Erro ao criar o arquivo de resultados do benchmark");
+        return;
+    }
+    fprintf(saida, "programa,operacao,vertices,arestas,threads,consultas,vazao_por_s,p50_us,p90_us,p99_us,max_us\n");
+    verificarTabelaComPesosGrandes();
+
+    const int contagensThreads[] = {1, 2, 4, 8};
+    double* latencias = (double*)malloc(CONSULTAS_BENCHMARK * sizeof(double));
+    if (!latencias) {
+        perror("Erro ao alocar memória para o benchmark");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int tipo = MAPA_GRADE; tipo <= MAPA_GEOMETRICO; tipo++) {
+        for (int numCidades = 16; numCidades <= MAX_CIDADES; numCidades *= 4) {
+            // Mede a construção do mapa (cidades + rotas).
+            MapaCidades* mapa = criarMapaCidades();
+            double inicio = agoraMicrossegundos();
+            long rotas = gerarMapaSintetico(mapa, tipo, numCidades, 42 + (uint64_t)numCidades);
+            double tempoConstrucao = agoraMicrossegundos() - inicio;
+            escreverResultadoBenchmark(saida, nomesMapasBenchmark[tipo], "construcao", numCidades, rotas, 1,
+                                       &tempoConstrucao, 1, tempoConstrucao);
+            printf("Mapa '%s' com %d cidades e %ld rotas gerado em %.1f ms.\n",
+                   nomesMapasBenchmark[tipo], numCidades, rotas, tempoConstrucao / 1e3);
+
+            for (int operacao = 0; operacao < NUM_OPERACOES_BENCHMARK; operacao++) {
+                if (operacao == BENCH_DIJKSTRA_TABELA) {
+                    // Mede o cálculo da tabela de todos os pares (só em mapas pequenos) e a deixa no mapa.
+                    if (numCidades > MAX_CIDADES_APSP_BENCHMARK) continue;
+                    inicio = agoraMicrossegundos();
+                    mapa->todosOsPares = calcularTodosOsPares(mapa);
+                    double tempoTabela = agoraMicrossegundos() - inicio;
+                    escreverResultadoBenchmark(saida, nomesMapasBenchmark[tipo], "todos_os_pares", numCidades, rotas, 1,
+                                               &tempoTabela, 1, tempoTabela);
+                    printf("Tabela de todos os pares: %d divergência(s) do Dijkstra em %d consultas.\n",
+                           verificarTabelaTodosOsPares(mapa, numCidades, CONSULTAS_BENCHMARK, 23), CONSULTAS_BENCHMARK);
+                }
+                for (size_t t = 0; t < sizeof(contagensThreads) / sizeof(contagensThreads[0]); t++) {
+                    int numThreads = contagensThreads[t];
+                    pthread_t threads[8];
+                    TarefaBenchmark tarefas[8];
+                    // Divide o total de consultas entre as threads (a última recebe o resto).
+                    int porThread = CONSULTAS_BENCHMARK / numThreads;
+                    inicio = agoraMicrossegundos();
+                    for (int i = 0; i < numThreads; i++) {
+                        tarefas[i].mapa = mapa;
+                        tarefas[i].operacao = operacao;
+                        tarefas[i].numCidades = numCidades;
+                        tarefas[i].consultas = i == numThreads - 1 ? CONSULTAS_BENCHMARK - porThread * i : porThread;
+                        tarefas[i].semente = 1000 + (uint64_t)i;
+                        tarefas[i].latencias = latencias + porThread * i;
+                        pthread_create(&threads[i], NULL, executarTarefaBenchmark, &tarefas[i]);
+                    }
+                    for (int i = 0; i < numThreads; i++) pthread_join(threads[i], NULL);
+                    double tempoTotal = agoraMicrossegundos() - inicio;
+                    escreverResultadoBenchmark(saida, nomesMapasBenchmark[tipo], nomesOperacoesBenchmark[operacao],
+                                               numCidades, rotas, numThreads, latencias, CONSULTAS_BENCHMARK, tempoTotal);
+                }
+            }
+            // Mede a divisão em NUM_PARTICOES_BENCHMARK processos e consultas particionadas de cidades aleatórias.
+            inicio = agoraMicrossegundos();
+            ExecucaoParticionada* exec = criarExecucaoParticionada(mapa, NUM_PARTICOES_BENCHMARK);
+            double tempoParticoes = agoraMicrossegundos() - inicio;
+            escreverResultadoBenchmark(saida, nomesMapasBenchmark[tipo], "construcaoParticoes", numCidades, rotas,
+                                       NUM_PARTICOES_BENCHMARK, &tempoParticoes, 1, tempoParticoes);
+            uint64_t semente = 7;
+            inicio = agoraMicrossegundos();
+            for (int i = 0; i < CONSULTAS_PARTICIONADAS_BENCHMARK; i++) {
+                double inicioConsulta = agoraMicrossegundos();
+                menoresCustosParticionados(exec, (int)(proximoAleatorio(&semente) % (uint64_t)numCidades));
+                latencias[i] = agoraMicrossegundos() - inicioConsulta;
+            }
+            double tempoParticionadas = agoraMicrossegundos() - inicio;
+            escreverResultadoBenchmark(saida, nomesMapasBenchmark[tipo], "menoresCustosParticionados", numCidades, rotas,
+                                       NUM_PARTICOES_BENCHMARK, latencias, CONSULTAS_PARTICIONADAS_BENCHMARK, tempoParticionadas);
+            long rotasCortadas = 0;
+            for (int p = 0; p < NUM_PARTICOES_BENCHMARK; p++) rotasCortadas += exec->particoes[p]->rotasCortadas;
+            printf("Corte da divisão em %d processos: %.1f%% das rotas.\n", NUM_PARTICOES_BENCHMARK,
+                   rotas > 0 ? 100.0 * (double)rotasCortadas / (double)rotas : 0.0);
+            liberarExecucaoParticionada(exec);
+            liberarMapaCidades(mapa);
+        }
+    }
+    free(latencias);
+    fclose(saida);
+    printf("Resultados do benchmark gravados em %s.\n", caminhoSaida);
+}
+
+
 // Função principal do programa.
 // Configura a localização, cria o mapa, cadastra algumas cidades e rotas iniciais (para teste/exemplo),
 // e entra em um loop para exibir o menu e processar as escolhas do usuário.
+// Com os argumentos "--servidor <caminho do socket>", executa como servidor de consultas em vez do menu.
+// Com "--benchmark <arquivo.csv>", gera mapas sintéticos, mede as consultas e grava os resultados no arquivo.
+// "--estatisticas" antes desses argumentos (ou sozinho, para o menu) ativa as estatísticas por consulta.
 // Libera a memória alocada antes de terminar.
-int main() {
+int main(int argc, char* argv[]) {
     // Tenta configurar a localização para Português do Brasil (UTF-8 ou outros fallbacks).
     // Isso é importante para a correta exibição de caracteres acentuados no console.
     if (setlocale(LC_ALL, "pt_BR.UTF-8") == NULL) {
@@ -322,6 +2408,24 @@ int main() {
         }
     }
 
+    // Ativa a coleta de estatísticas das consultas (mostradas a cada consulta e agregadas ao sair).
+    if (argc >= 2 && strcmp(argv[1], "--estatisticas") == 0) {
+#ifdef SEM_ESTATISTICAS
+        fprintf(stderr, "Erro: programa compilado com -DSEM_ESTATISTICAS; a opção --estatisticas não está disponível.\n");
+        return EXIT_FAILURE;
+#else
+        estatisticasAtivas = true;
+        argv++;
+        argc--;
+#endif
+    }
+
+    // Modo benchmark: usa apenas mapas gerados.
+    if (argc >= 3 && strcmp(argv[1], "--benchmark") == 0) {
+        executarBenchmark(argv[2]);
+        return 0;
+    }
+
     MapaCidades* mapa = criarMapaCidades(); // Cria e inicializa o mapa.
     int opcao;                              // Variável para armazenar a escolha do usuário no menu.
     char nome[MAX_NOME_CIDADE];             // Buffer para ler o nome da cidade.
@@ -345,6 +2449,13 @@ int main() {
     if(cB !=-1 && cA !=-1) cadastrarRota(mapa, cB, cA, 6); // Rota de volta (exemplo de grafo direcionado)
 
 
+    // Modo servidor: atende consultas pelo socket até receber SIGINT/SIGTERM.
+    if (argc >= 3 && strcmp(argv[1], "--servidor") == 0) {
+        executarServidor(mapa, argv[2]);
+        liberarMapaCidades(mapa);
+        return 0;
+    }
+
     // Loop principal do menu. Continua até o usuário escolher a opção 0 (Sair).
     do {
         exibirMenuCidades(); // Mostra as opções.
@@ -389,6 +2500,37 @@ int main() {
             case 5: // Listar todas as cidades ativas
                 listarCidadesAtivas(mapa);
                 break;
+            case 6: { // Calcular Área Alcançável (Isócrona)
+                int origens[MAX_CIDADES], numOrigens, limite;
+                printf("Digite o número de cidades de origem: ");
+                if (scanf("%d", &numOrigens) != 1 || numOrigens < 1 || numOrigens > MAX_CIDADES) {
+                    printf("Número de origens inválido.\n"); while (getchar() != '\n'); break;
+                }
+                bool leituraValida = true;
+                for (int i = 0; i < numOrigens && leituraValida; i++) {
+                    printf("Digite o ID da cidade de origem %d: ", i + 1);
+                    if (scanf("%d", &origens[i]) != 1) leituraValida = false;
+                }
+                if (!leituraValida) { printf("ID inválido.\n"); while (getchar() != '\n'); break; }
+                printf("Digite o custo máximo: ");
+                if (scanf("%d", &limite) != 1) { printf("Custo inválido.\n"); while (getchar() != '\n'); break; }
+                getchar(); // Consome o newline.
+                isocrona(mapa, origens, numOrigens, limite);
+                break;
+            }
+            case 7: // Calcular Menores Caminhos entre Todos os Pares
+                todosOsPares(mapa);
+                break;
+            case 8: { // Calcular Menores Custos em Vários Processos (Particionado)
+                int numParticoes;
+                printf("Digite o ID da cidade de origem: ");
+                if (scanf("%d", &idOrigem) != 1) { printf("ID inválido.\n"); while (getchar() != '\n'); break; }
+                printf("Digite o número de processos (1 a %d): ", MAX_PARTICOES);
+                if (scanf("%d", &numParticoes) != 1) { printf("Número inválido.\n"); while (getchar() != '\n'); break; }
+                getchar(); // Consome o newline.
+                menoresCustosEmParticoes(mapa, idOrigem, numParticoes);
+                break;
+            }
             case 0: // Sair
                 printf("Saindo do Sistema de Rotas...\n");
                 break;
@@ -397,6 +2539,8 @@ int main() {
         }
     } while (opcao != 0); // Continua o loop enquanto a opção não for 0.
 
+    if (estatisticasAtivas) imprimirHistogramas(stdout, agregadosMenu);
+    liberarAreaTrabalhoDaThread();
     liberarMapaCidades(mapa); // Libera toda a memória alocada antes de encerrar.
     return 0; // Retorna 0 indicando sucesso na execução do programa.
 }
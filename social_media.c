@@ -1,3 +1,10 @@
+// Habilita as declarações POSIX (fsync, ftruncate) mesmo quando o compilador está em modo C estrito.
+#define _POSIX_C_SOURCE 200809L
+// Habilita também MAP_ANONYMOUS (memória compartilhada da execução particionada), que não é POSIX,
+// tanto na glibc quanto no macOS (onde _POSIX_C_SOURCE esconde as extensões do sistema).
+#define _DEFAULT_SOURCE
+#define _DARWIN_C_SOURCE
+
 // Inclui a biblioteca padrão de entrada e saída (para funções como printf, scanf).
 #include <stdio.h>
 // Inclui a biblioteca padrão para alocação de memória, controle de processos e outras utilidades (para funções como malloc, free, exit).
@@ -6,14 +13,87 @@
 #include <string.h>
 // Inclui a biblioteca para usar o tipo booleano (bool, true, false).
 #include <stdbool.h>
+// Inclui a biblioteca de inteiros de tamanho fixo (para uint64_t, usado no bitmap de usuários ativos).
+#include <stdint.h>
+// Inclui os limites dos tipos inteiros (INT_MAX).
+#include <limits.h>
 // Inclui a biblioteca para configurações de localidade (para acentuação e formatação regional).
 #include <locale.h>
+// Inclui as chamadas POSIX de arquivos (open, write, fsync, ftruncate) usadas pelo journal de persistência.
+#include <fcntl.h>
+#include <unistd.h>
+// Inclui errno, para repetir leituras e escritas interrompidas por sinais.
+#include <errno.h>
+// Inclui as bibliotecas usadas pelo modo servidor (sockets Unix, laço de eventos, threads e atômicos).
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sched.h>
+#include <stdatomic.h>
+// Inclui a biblioteca de tempo (clock_gettime), usada para medir as consultas no modo benchmark.
+#include <time.h>
+// Inclui as chamadas de memória compartilhada e de processos (mmap, fork, waitpid) da execução particionada.
+#include <sys/mman.h>
+#include <sys/wait.h>
+#if defined(__AVX2__) || defined(__SSE2__)
+// Inclui as instruções SIMD usadas para unir os contadores HyperLogLog do HyperANF.
+#include <immintrin.h>
+#endif
 
 // Define o número máximo de usuários que a rede social pode ter.
+// Pode ser alterado na compilação (por exemplo, -DMAX_USUARIOS=65536 para o modo benchmark).
+#ifndef MAX_USUARIOS
 #define MAX_USUARIOS 100
+#endif
 // Define o tamanho máximo para o nome de um usuário.
 #define MAX_NOME_USUARIO 50
 
+// Define os arquivos de persistência: o journal recebe as operações em modo somente-anexação e
+// o snapshot guarda o estado compactado da rede no momento da última compactação.
+#define ARQUIVO_JOURNAL "rede_social.journal"
+#define ARQUIVO_SNAPSHOT "rede_social.snapshot"
+// Define o "número mágico" gravado no início de cada arquivo, usado para reconhecer o formato.
+#define MAGICO_JOURNAL "RSJ1"
+#define MAGICO_SNAPSHOT "RSS1"
+// Define os códigos das operações registradas (primeiro byte de cada registro).
+#define OP_JOURNAL_USUARIO 1   // Registro: [1][int32 id][uint8 tamanho][nome] - usuário adicionado.
+#define OP_JOURNAL_CONEXAO 2   // Registro: [2][int32 id1][int32 id2] - amizade criada.
+// Define o tamanho do buffer de escrita do journal e quantas operações são agrupadas em um único fsync.
+#define TAMANHO_BUFFER_JOURNAL (64 * 1024)
+#define LOTE_COMMIT_JOURNAL 256
+// Define quantas operações o journal acumula antes de ser compactado em um novo snapshot.
+#define LIMITE_OPERACOES_SNAPSHOT 100000
+// Define o tamanho do bloco lido de cada vez durante a reprodução (replay) dos arquivos.
+#define TAMANHO_BLOCO_REPLAY (1024 * 1024)
+// Define os resultados especiais da reprodução de um arquivo (os demais são o tamanho válido em bytes).
+#define ARQUIVO_AUSENTE -1     // O arquivo não existe, está vazio ou tem só parte do cabeçalho.
+#define ARQUIVO_CORROMPIDO -2  // Cabeçalho errado ou código de operação desconhecido no meio do arquivo.
+
+// Define os parâmetros do modo servidor: threads trabalhadoras e clientes conectados simultaneamente.
+#define NUM_TRABALHADORES 4
+#define MAX_CLIENTES 64
+// Define o tempo máximo para enviar uma resposta a um cliente que não a lê (o trabalhador desiste dele).
+#define TEMPO_LIMITE_ESCRITA_MS 2000
+// Define os códigos das operações do protocolo binário do servidor.
+#define OP_SERVIDOR_BFS 1                // Argumentos: [id]      -> pares (id, nível) na ordem da BFS.
+#define OP_SERVIDOR_SUGERIR_AMIGOS 2     // Argumentos: [id]      -> pares (sugerido, amigo em comum).
+#define OP_SERVIDOR_CONECTIVIDADE 3      // Argumentos: [id1, id2] -> um inteiro (1 conectados, 0 não).
+#define OP_SERVIDOR_CRIAR_CONEXAO 4      // Argumentos: [id1, id2] -> sem dados (escrita).
+#define OP_SERVIDOR_USUARIOS_SIMILARES 5 // Argumentos: [id, k]   -> pares (usuário, hashes iguais de 32) por similaridade.
+#define OP_SERVIDOR_K_SALTOS 6           // Argumentos: [id, k, máximo] -> pares (usuário, nível) por nível e ID.
+// Define os códigos de status das respostas do servidor.
+#define STATUS_OK 0
+#define STATUS_ARGUMENTO_INVALIDO 1
+#define STATUS_OPERACAO_DESCONHECIDA 2
+
+// Define os parâmetros do modo benchmark: total de consultas por medição e amizades geradas por usuário.
+#define CONSULTAS_BENCHMARK 256
+#define FATOR_ARESTAS_BENCHMARK 8
+#define NUM_PARTICOES_BENCHMARK 4             // Processos da BFS particionada no modo benchmark.
+#define CONSULTAS_PARTICIONADAS_BENCHMARK 32  // BFSs particionadas medidas por rede (cada uma percorre a rede toda).
+
 // Define a estrutura para um nó da lista de amigos.
 // Cada nó armazena o ID de um usuário amigo e um ponteiro para o próximo amigo na lista.
 typedef struct NoAmigo {
@@ -21,21 +101,325 @@ typedef struct NoAmigo {
     struct NoAmigo* proximo; // Ponteiro para o próximo nó amigo na lista.
 } NoAmigo;
 
-// Define a estrutura para um usuário da rede social.
-typedef struct Usuario {
-    int id;                             // Identificador único do usuário.
-    char nome[MAX_NOME_USUARIO];      // Nome do usuário.
-    NoAmigo* listaAmigos;             // Ponteiro para o início da lista de amigos do usuário.
-    bool ativo;                       // Flag que indica se o usuário está ativo (true) ou não (false).
-} Usuario;
+// Parâmetros do índice de usuários similares (MinHash + LSH): 32 hashes em 16 bandas de 2 linhas.
+// Dois usuários com similaridade de Jaccard s viram candidatos com probabilidade 1 - (1 - s^2)^16:
+// cerca de 78% para s = 0,3 e 99% para s = 0,5. Ocupa 384 bytes fixos por usuário.
+#define NUM_HASHES_MINHASH 32
+#define NUM_BANDAS_LSH 16
+#define LINHAS_POR_BANDA (NUM_HASHES_MINHASH / NUM_BANDAS_LSH)
+#define NUM_BALDES_LSH MAX_USUARIOS      // Baldes por banda.
+#define MAX_CANDIDATOS_LSH 256           // Candidatos examinados por balde (limita o custo em baldes cheios).
+#define MAX_RESULTADOS_SIMILARES 10      // Usuários similares mostrados no menu.
+
+// Parâmetros do oráculo de distâncias por marcos: NUM_MARCOS bytes por usuário.
+#ifndef NUM_MARCOS
+#define NUM_MARCOS 16
+#endif
+#define NIVEL_DESCONHECIDO 255           // Nível não alcançado (ou acima de 254) no oráculo.
+#define NUM_THREADS_ORACULO 4            // Threads usadas para reconstruir o oráculo.
+
+// Parâmetros do HyperANF: contadores HyperLogLog de 2^BITS_HLL registradores de 1 byte por usuário
+// (erro padrão de cerca de 1,04 / sqrt(2^BITS_HLL): 9% com 128 registradores).
+#ifndef BITS_HLL
+#define BITS_HLL 7
+#endif
+#if BITS_HLL < 5 || BITS_HLL > 16
+#error "BITS_HLL deve estar entre 5 e 16 (a união vetorizada processa 32 registradores por vez)."
+#endif
+#define REGISTRADORES_HLL (1 << BITS_HLL)
+#define MAX_PASSOS_HYPERANF 32           // Maior número de saltos calculado pelo HyperANF.
+#define NUM_THREADS_HYPERANF 4           // Threads que dividem cada passo do HyperANF.
+#define BLOCO_USUARIOS_HYPERANF 256      // Usuários que cada thread pega por vez do contador atômico.
+
+// Parâmetros da contagem de triângulos.
+#define NUM_THREADS_TRIANGULOS 4         // Threads que dividem a contagem.
+#define BLOCO_USUARIOS_TRIANGULOS 64     // Usuários que cada thread pega por vez do contador atômico.
+
+// Parâmetros da execução particionada em processos.
+#define MAX_PARTICOES 16                 // Maior número de processos (partições) de uma execução.
+#define MAX_SUPERPASSOS_PARTICIONADOS (MAX_USUARIOS + 1) // Superpassos registrados (níveis da BFS + 1).
+
+// Define o índice aproximado de usuários similares (MinHash + LSH).
+// Cada usuário tem uma assinatura MinHash do seu conjunto de amigos: para cada uma das NUM_HASHES_MINHASH
+// funções de hash, o menor hash entre os amigos. A fração de posições iguais em duas assinaturas estima a
+// similaridade de Jaccard entre os conjuntos de amigos. As assinaturas são divididas em NUM_BANDAS_LSH
+// bandas; usuários com uma banda idêntica caem no mesmo balde e viram candidatos, de modo que a busca
+// só examina os baldes do usuário em vez da rede inteira.
+// Os baldes são listas duplamente encadeadas por índice (sem ponteiros), para que a estrutura tenha
+// tamanho fixo e a rede continue podendo ser copiada com memcpy. Só entram no índice usuários com amigos.
+typedef struct IndiceSimilaridade {
+    uint32_t assinatura[MAX_USUARIOS][NUM_HASHES_MINHASH]; // Assinatura MinHash de cada usuário.
+    uint32_t chaveBanda[NUM_BANDAS_LSH][MAX_USUARIOS];     // Hash de cada banda da assinatura de cada usuário.
+    int inicioBalde[NUM_BANDAS_LSH][NUM_BALDES_LSH];       // Primeiro usuário de cada balde (-1 se vazio).
+    int proximoNoBalde[NUM_BANDAS_LSH][MAX_USUARIOS];      // Próximo usuário no mesmo balde (-1 no fim).
+    int anteriorNoBalde[NUM_BANDAS_LSH][MAX_USUARIOS];     // Usuário anterior no mesmo balde (-1 no início).
+} IndiceSimilaridade;
+
+// Define o número de palavras de 64 bits necessárias para o bitmap de usuários ativos.
+#define PALAVRAS_BITMAP_USUARIOS ((MAX_USUARIOS + 63) / 64)
+// Define o tamanho da arena de nomes: espaço para todos os nomes mais a string vazia compartilhada na posição 0.
+#define TAMANHO_ARENA_NOMES (MAX_USUARIOS * MAX_NOME_USUARIO + 1)
 
 // Define a estrutura para a rede social.
-// Contém um array de usuários e o número de usuários ativos.
+// Os dados dos usuários ficam em arrays paralelos indexados pelo ID do usuário, separando
+// os dados "quentes" (bitmap de ativos e início das listas de amigos), lidos a cada passo de
+// BFS/DFS, dos nomes ("frios"), que só são lidos ao imprimir resultados.
 typedef struct RedeSocial {
-    Usuario usuarios[MAX_USUARIOS]; // Array para armazenar todos os usuários.
-    int numUsuariosAtivos;          // Contador de usuários atualmente ativos na rede.
+    uint64_t usuariosAtivos[PALAVRAS_BITMAP_USUARIOS]; // Bitmap: o bit i ligado indica que o usuário i está ativo.
+    NoAmigo* listaAmigos[MAX_USUARIOS];                // Início da lista de amigos de cada usuário.
+    int offsetNome[MAX_USUARIOS];                      // Posição do nome de cada usuário dentro da arena de nomes.
+    char arenaNomes[TAMANHO_ARENA_NOMES];              // Arena contígua com os nomes dos usuários (terminados em '\0').
+    int tamanhoArena;                                  // Quantidade de bytes já ocupados na arena de nomes.
+    int numUsuariosAtivos;                             // Contador de usuários atualmente ativos na rede.
+    unsigned long versao;                              // Versão dos dados: incrementada a cada usuário ou amizade adicionada.
+    struct Journal* journal;                           // Journal de persistência (NULL: operações não são registradas).
+    IndiceSimilaridade similaridade;                   // Índice MinHash/LSH de usuários similares.
+    struct OraculoDistancias* oraculo;                 // Oráculo de distâncias por marcos (NULL se nunca construído).
 } RedeSocial;
 
+// Define a estrutura do journal de persistência.
+// As operações são acumuladas em um buffer e gravadas em lote ("group commit"): um único fsync
+// torna duráveis todas as operações pendentes, em vez de um fsync por operação.
+typedef struct Journal {
+    int descritor;                                  // Descritor do arquivo de journal, aberto para anexação.
+    unsigned char buffer[TAMANHO_BUFFER_JOURNAL];   // Registros ainda não gravados no arquivo.
+    size_t bytesNoBuffer;                           // Quantidade de bytes ocupados no buffer.
+    int operacoesPendentes;                         // Operações registradas desde o último fsync.
+    long operacoesDesdeSnapshot;                    // Operações no journal desde a última compactação.
+} Journal;
+
+// Função que verifica se o usuário de ID 'id' está ativo (teste de um único bit no bitmap).
+static inline bool usuarioAtivo(const RedeSocial* rede, int id) {
+    return (rede->usuariosAtivos[id >> 6] >> (id & 63)) & 1u;
+}
+
+// Função que marca o usuário de ID 'id' como ativo no bitmap.
+static inline void marcarUsuarioAtivo(RedeSocial* rede, int id) {
+    rede->usuariosAtivos[id >> 6] |= (uint64_t)1 << (id & 63);
+}
+
+// Função que retorna o nome do usuário de ID 'id' (string vazia se o slot nunca foi usado).
+static inline const char* nomeUsuario(const RedeSocial* rede, int id) {
+    return &rede->arenaNomes[rede->offsetNome[id]];
+}
+
+// ---------------------------------------------------------------------------------------------
+// Estatísticas por consulta (instrumentação opcional dos algoritmos).
+// As funções de consulta recebem um ponteiro EstatisticasConsulta*: com NULL nada é contado (o custo
+// é um teste de ponteiro por evento); compilando com -DSEM_ESTATISTICAS a contagem é removida por completo.
+// ---------------------------------------------------------------------------------------------
+
+#define MAX_NIVEIS_ESTATISTICAS 32   // Níveis de fronteira registrados (os mais profundos somam no último).
+#define NUM_FAIXAS_HISTOGRAMA 24     // Faixas de potência de 2 dos histogramas agregados.
+
+// Fases de uma consulta cujo tempo é medido separadamente.
+#define FASE_INICIALIZACAO 0         // Preparação dos arrays de trabalho.
+#define FASE_BUSCA 1                 // Laço principal do algoritmo.
+#define NUM_FASES_CONSULTA 2
+
+// Operações com estatísticas agregadas (uma entrada em cada array de AgregadoEstatisticas).
+#define ESTATISTICAS_BFS 0
+#define ESTATISTICAS_SUGERIR_AMIGOS 1
+#define NUM_OPERACOES_ESTATISTICAS 2
+
+// Nomes das operações e das fases nos relatórios.
+static const char* const nomesOperacoesEstatisticas[NUM_OPERACOES_ESTATISTICAS] = {"bfs", "sugerir_amigos"};
+static const char* const nomesFasesConsulta[NUM_FASES_CONSULTA] = {"inicialização", "busca"};
+
+// Define as estatísticas de uma única consulta, preenchidas pela função que a executa.
+// As buscas deste programa não têm pesos: a "fila" é a fila FIFO da BFS (vazia nas sugestões, que só
+// percorrem dois níveis de listas) e uma aresta é "relaxada" quando descobre um usuário novo.
+typedef struct EstatisticasConsulta {
+    long verticesFixados;                            // Usuários processados (retirados da fila ou expandidos).
+    long arestasInspecionadas;                       // Amizades percorridas nas listas de adjacência.
+    long arestasRelaxadas;                           // Amizades que levaram a um usuário ainda não visto.
+    long insercoesFila;                              // Usuários colocados na fila da busca.
+    long remocoesFila;                               // Usuários retirados da fila da busca.
+    int numNiveis;                                   // Níveis usados em 'tamanhoFronteira' (0 se não se aplica).
+    long tamanhoFronteira[MAX_NIVEIS_ESTATISTICAS];  // Vértices descobertos em cada nível da busca.
+    long bytesAlocados;                              // Memória de trabalho escrita pela consulta.
+    double tempoFase[NUM_FASES_CONSULTA];            // Tempo de cada fase, em microssegundos.
+} EstatisticasConsulta;
+
+// Define as estatísticas agregadas de várias consultas de uma mesma operação (somas e histogramas).
+// A faixa i dos histogramas conta os valores em [2^(i-1), 2^i - 1] (a faixa 0 conta o valor 0).
+typedef struct AgregadoEstatisticas {
+    long consultas;
+    long somaVerticesFixados, somaArestasInspecionadas, somaArestasRelaxadas;
+    long somaInsercoesFila, somaRemocoesFila, somaBytesAlocados;
+    double somaTempoFase[NUM_FASES_CONSULTA];
+    long histogramaTempo[NUM_FAIXAS_HISTOGRAMA];     // Tempo total da consulta (µs).
+    long histogramaArestas[NUM_FAIXAS_HISTOGRAMA];   // Arestas inspecionadas.
+    long histogramaFronteira[NUM_FAIXAS_HISTOGRAMA]; // Maior fronteira (0 se a operação não tem níveis).
+} AgregadoEstatisticas;
+
+#ifdef SEM_ESTATISTICAS
+// Sem instrumentação a coleta nunca é ativada ("--estatisticas" é recusada): como a constante é conhecida
+// na compilação, os relatórios do menu e do servidor também são removidos.
+#define estatisticasAtivas false
+// 'valor' só aparece dentro de sizeof (não é avaliado), para que as variáveis usadas apenas nos contadores
+// não fiquem sem uso.
+#define CONTAR_ESTATISTICA(estatisticas, campo, valor) ((void)sizeof(valor))
+#else
+// Ativada pela opção "--estatisticas": o menu e o servidor passam a coletar e relatar estatísticas.
+static bool estatisticasAtivas = false;
+
+// Soma 'valor' ao contador 'campo' quando a coleta está ativa para esta consulta.
+#define CONTAR_ESTATISTICA(estatisticas, campo, valor) \
+    do { if (estatisticas) (estatisticas)->campo += (valor); } while (0)
+#endif
+
+// Retorna o instante atual em microssegundos (relógio monotônico).
+double agoraMicrossegundos(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec * 1e6 + (double)t.tv_nsec / 1e3;
+}
+
+// Zera as estatísticas e registra a memória de trabalho. Retorna o instante inicial da primeira fase
+// (0 quando a coleta está desativada, para não consultar o relógio).
+static inline double iniciarEstatisticas(EstatisticasConsulta* estatisticas, long bytesAlocados) {
+#ifndef SEM_ESTATISTICAS
+    if (estatisticas) {
+        memset(estatisticas, 0, sizeof(*estatisticas));
+        estatisticas->bytesAlocados = bytesAlocados;
+        return agoraMicrossegundos();
+    }
+#endif
+    (void)estatisticas;
+    (void)bytesAlocados;
+    return 0;
+}
+
+// Encerra a fase 'fase', somando o tempo desde '*marca', e reinicia a marca para a fase seguinte.
+static inline void encerrarFase(EstatisticasConsulta* estatisticas, int fase, double* marca) {
+#ifndef SEM_ESTATISTICAS
+    if (estatisticas) {
+        double agora = agoraMicrossegundos();
+        estatisticas->tempoFase[fase] += agora - *marca;
+        *marca = agora;
+    }
+#endif
+    (void)estatisticas;
+    (void)fase;
+    (void)marca;
+}
+
+// Conta um vértice descoberto no nível 'nivel' da busca.
+static inline void contarFronteira(EstatisticasConsulta* estatisticas, int nivel) {
+#ifndef SEM_ESTATISTICAS
+    if (estatisticas) {
+        if (nivel >= MAX_NIVEIS_ESTATISTICAS) nivel = MAX_NIVEIS_ESTATISTICAS - 1;
+        if (nivel >= estatisticas->numNiveis) estatisticas->numNiveis = nivel + 1;
+        estatisticas->tamanhoFronteira[nivel]++;
+    }
+#endif
+    (void)estatisticas;
+    (void)nivel;
+}
+
+// Retorna a faixa do histograma de um valor não negativo (número de bits significativos, limitado).
+int faixaHistograma(long valor) {
+    int faixa = 0;
+    while (valor > 0 && faixa < NUM_FAIXAS_HISTOGRAMA - 1) {
+        valor >>= 1;
+        faixa++;
+    }
+    return faixa;
+}
+
+// Soma as estatísticas de uma consulta ao agregado da sua operação.
+void acumularEstatisticas(AgregadoEstatisticas* agregado, const EstatisticasConsulta* estatisticas) {
+    double tempoTotal = 0;
+    long maiorFronteira = 0;
+    for (int f = 0; f < NUM_FASES_CONSULTA; f++) {
+        agregado->somaTempoFase[f] += estatisticas->tempoFase[f];
+        tempoTotal += estatisticas->tempoFase[f];
+    }
+    for (int n = 0; n < estatisticas->numNiveis; n++) {
+        if (estatisticas->tamanhoFronteira[n] > maiorFronteira) maiorFronteira = estatisticas->tamanhoFronteira[n];
+    }
+    agregado->consultas++;
+    agregado->somaVerticesFixados += estatisticas->verticesFixados;
+    agregado->somaArestasInspecionadas += estatisticas->arestasInspecionadas;
+    agregado->somaArestasRelaxadas += estatisticas->arestasRelaxadas;
+    agregado->somaInsercoesFila += estatisticas->insercoesFila;
+    agregado->somaRemocoesFila += estatisticas->remocoesFila;
+    agregado->somaBytesAlocados += estatisticas->bytesAlocados;
+    agregado->histogramaTempo[faixaHistograma((long)tempoTotal)]++;
+    agregado->histogramaArestas[faixaHistograma(estatisticas->arestasInspecionadas)]++;
+    agregado->histogramaFronteira[faixaHistograma(maiorFronteira)]++;
+}
+
+// Soma o agregado 'origem' ao agregado 'destino' (usado para juntar os agregados de várias threads).
+void combinarAgregados(AgregadoEstatisticas* destino, const AgregadoEstatisticas* origem) {
+    destino->consultas += origem->consultas;
+    destino->somaVerticesFixados += origem->somaVerticesFixados;
+    destino->somaArestasInspecionadas += origem->somaArestasInspecionadas;
+    destino->somaArestasRelaxadas += origem->somaArestasRelaxadas;
+    destino->somaInsercoesFila += origem->somaInsercoesFila;
+    destino->somaRemocoesFila += origem->somaRemocoesFila;
+    destino->somaBytesAlocados += origem->somaBytesAlocados;
+    for (int f = 0; f < NUM_FASES_CONSULTA; f++) destino->somaTempoFase[f] += origem->somaTempoFase[f];
+    for (int i = 0; i < NUM_FAIXAS_HISTOGRAMA; i++) {
+        destino->histogramaTempo[i] += origem->histogramaTempo[i];
+        destino->histogramaArestas[i] += origem->histogramaArestas[i];
+        destino->histogramaFronteira[i] += origem->histogramaFronteira[i];
+    }
+}
+
+// Imprime as estatísticas de uma consulta.
+void imprimirEstatisticas(const EstatisticasConsulta* estatisticas) {
+    printf("  [estatísticas] vértices fixados: %ld | arestas inspecionadas: %ld | relaxadas: %ld\n",
+           estatisticas->verticesFixados, estatisticas->arestasInspecionadas, estatisticas->arestasRelaxadas);
+    printf("  [estatísticas] inserções na fila: %ld | remoções: %ld | memória de trabalho: %ld bytes\n",
+           estatisticas->insercoesFila, estatisticas->remocoesFila, estatisticas->bytesAlocados);
+    printf("  [estatísticas] tempo (µs):");
+    for (int f = 0; f < NUM_FASES_CONSULTA; f++) {
+        printf(" %s %.1f", nomesFasesConsulta[f], estatisticas->tempoFase[f]);
+    }
+    printf("\n");
+    if (estatisticas->numNiveis > 0) {
+        printf("  [estatísticas] fronteira por nível:");
+        for (int n = 0; n < estatisticas->numNiveis; n++) printf(" %ld", estatisticas->tamanhoFronteira[n]);
+        printf("\n");
+    }
+}
+
+// Imprime em 'saida' as médias e os histogramas de cada operação com consultas registradas.
+void imprimirHistogramas(FILE* saida, const AgregadoEstatisticas agregados[]) {
+    for (int op = 0; op < NUM_OPERACOES_ESTATISTICAS; op++) {
+        const AgregadoEstatisticas* agregado = &agregados[op];
+        if (agregado->consultas == 0) continue;
+        double n = (double)agregado->consultas;
+        fprintf(saida, "\n=== Estatísticas agregadas: %s (%ld consultas) ===\n",
+                nomesOperacoesEstatisticas[op], agregado->consultas);
+        fprintf(saida, "Médias: vértices fixados %.1f, arestas inspecionadas %.1f, relaxadas %.1f, "
+                "inserções %.1f, remoções %.1f, memória %.0f bytes\n",
+                (double)agregado->somaVerticesFixados / n, (double)agregado->somaArestasInspecionadas / n,
+                (double)agregado->somaArestasRelaxadas / n, (double)agregado->somaInsercoesFila / n,
+                (double)agregado->somaRemocoesFila / n, (double)agregado->somaBytesAlocados / n);
+        fprintf(saida, "Tempo médio por fase (µs):");
+        for (int f = 0; f < NUM_FASES_CONSULTA; f++) {
+            fprintf(saida, " %s %.1f", nomesFasesConsulta[f], agregado->somaTempoFase[f] / n);
+        }
+        fprintf(saida, "\n%-22s %12s %12s %12s\n", "Faixa", "tempo (µs)", "arestas", "fronteira");
+        for (int i = 0; i < NUM_FAIXAS_HISTOGRAMA; i++) {
+            if (agregado->histogramaTempo[i] == 0 && agregado->histogramaArestas[i] == 0 &&
+                agregado->histogramaFronteira[i] == 0) continue;
+            long minimo = i == 0 ? 0 : 1L << (i - 1), maximo = i == 0 ? 0 : (1L << i) - 1;
+            char faixa[32];
+            if (i == NUM_FAIXAS_HISTOGRAMA - 1) snprintf(faixa, sizeof(faixa), "[%ld, ...]", minimo);
+            else snprintf(faixa, sizeof(faixa), "[%ld, %ld]", minimo, maximo);
+            fprintf(saida, "%-22s %12ld %12ld %12ld\n", faixa, agregado->histogramaTempo[i],
+                    agregado->histogramaArestas[i], agregado->histogramaFronteira[i]);
+        }
+    }
+}
+
+// Agregados das consultas feitas pelo menu (relatados ao sair quando "--estatisticas" está ativa).
+static AgregadoEstatisticas agregadosMenu[NUM_OPERACOES_ESTATISTICAS];
+
 // Função para criar um novo nó de amigo.
 // Aloca memória para o nó, atribui o ID do usuário amigo e inicializa o próximo ponteiro como NULL.
 NoAmigo* criarNoAmigo(int idUsuario) {
@@ -55,16 +439,81 @@ NoAmigo* criarNoAmigo(int idUsuario) {
     return novoNo;
 }
 
+// Retorna o hash do amigo 'idAmigo' segundo a função de hash número 'funcao' da assinatura MinHash.
+static inline uint32_t hashMinHash(int funcao, int idAmigo) {
+    uint64_t x = (uint64_t)(uint32_t)idAmigo * 0x9E3779B97F4A7C15ULL + (uint64_t)(uint32_t)(funcao + 1) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 31)) * 0x94D049BB133111EBULL;
+    return (uint32_t)((x ^ (x >> 29)) >> 32);
+}
+
+// Retorna o hash da banda 'banda' de uma assinatura (combinação das suas LINHAS_POR_BANDA posições).
+static inline uint32_t calcularChaveBanda(const uint32_t assinatura[], int banda) {
+    uint64_t chave = 0x84222325CBF29CE4ULL;
+    for (int r = 0; r < LINHAS_POR_BANDA; r++) {
+        chave = (chave ^ assinatura[banda * LINHAS_POR_BANDA + r]) * 0x100000001B3ULL;
+    }
+    return (uint32_t)(chave ^ (chave >> 32));
+}
+
+// Função que inicializa o índice de similaridade vazio (assinaturas "infinitas" e baldes vazios).
+void inicializarIndiceSimilaridade(IndiceSimilaridade* indice) {
+    memset(indice->assinatura, 0xFF, sizeof(indice->assinatura));
+    memset(indice->inicioBalde, 0xFF, sizeof(indice->inicioBalde)); // Todos os bytes 0xFF: -1.
+}
+
+// Retira o usuário do balde da banda (a lista é duplamente encadeada, então a remoção é O(1)).
+static void removerDoBalde(IndiceSimilaridade* indice, int banda, int idUsuario) {
+    int anterior = indice->anteriorNoBalde[banda][idUsuario];
+    int proximo = indice->proximoNoBalde[banda][idUsuario];
+    if (anterior != -1) indice->proximoNoBalde[banda][anterior] = proximo;
+    else indice->inicioBalde[banda][indice->chaveBanda[banda][idUsuario] % NUM_BALDES_LSH] = proximo;
+    if (proximo != -1) indice->anteriorNoBalde[banda][proximo] = anterior;
+}
+
+// Coloca o usuário no início do balde correspondente à sua chave atual na banda.
+static void inserirNoBalde(IndiceSimilaridade* indice, int banda, int idUsuario) {
+    int balde = (int)(indice->chaveBanda[banda][idUsuario] % NUM_BALDES_LSH);
+    int primeiro = indice->inicioBalde[banda][balde];
+    indice->anteriorNoBalde[banda][idUsuario] = -1;
+    indice->proximoNoBalde[banda][idUsuario] = primeiro;
+    if (primeiro != -1) indice->anteriorNoBalde[banda][primeiro] = idUsuario;
+    indice->inicioBalde[banda][balde] = idUsuario;
+}
+
+// Atualiza o índice depois que 'idAmigo' entrou na lista de amigos de 'idUsuario'.
+// A assinatura MinHash é atualizada incrementalmente (mínimo com os hashes do novo amigo), e o usuário
+// só troca de balde nas bandas cuja chave mudou. Custo: O(NUM_HASHES_MINHASH), independente do grau.
+void atualizarIndiceSimilaridade(IndiceSimilaridade* indice, int idUsuario, int idAmigo) {
+    uint32_t* assinatura = indice->assinatura[idUsuario];
+    bool estavaNoIndice = assinatura[0] != UINT32_MAX; // Usuários sem amigos ficam fora do índice.
+    for (int banda = 0; banda < NUM_BANDAS_LSH; banda++) {
+        bool bandaMudou = false;
+        for (int r = 0; r < LINHAS_POR_BANDA; r++) {
+            int funcao = banda * LINHAS_POR_BANDA + r;
+            uint32_t h = hashMinHash(funcao, idAmigo);
+            if (h < assinatura[funcao]) {
+                assinatura[funcao] = h;
+                bandaMudou = true;
+            }
+        }
+        if (!bandaMudou && estavaNoIndice) continue;
+        if (estavaNoIndice) removerDoBalde(indice, banda, idUsuario);
+        indice->chaveBanda[banda][idUsuario] = calcularChaveBanda(assinatura, banda);
+        inserirNoBalde(indice, banda, idUsuario);
+    }
+}
+
 // Função para adicionar uma amizade à lista de amigos de um usuário.
 // A amizade é mútua, então esta função normalmente seria chamada duas vezes (uma para cada usuário).
-// Evita adicionar amizades duplicadas.
-void adicionarAmizadeNaLista(Usuario* usuario, int idAmigo) {
+// Evita adicionar amizades duplicadas. Também atualiza o índice de usuários similares.
+// Retorna true se a amizade foi adicionada ou false se ela já existia.
+bool adicionarAmizadeNaLista(RedeSocial* rede, int idUsuario, int idAmigo) {
     // Percorre a lista de amigos do usuário para verificar se a amizade já existe.
-    NoAmigo* atual = usuario->listaAmigos;
+    NoAmigo* atual = rede->listaAmigos[idUsuario];
     while (atual != NULL) {
         // Se o amigo já estiver na lista, não faz nada e retorna.
         if (atual->idUsuario == idAmigo) {
-            return;
+            return false;
         }
         atual = atual->proximo;
     }
@@ -72,8 +521,74 @@ void adicionarAmizadeNaLista(Usuario* usuario, int idAmigo) {
     // Se a amizade não existir, cria um novo nó para o amigo.
     NoAmigo* novoAmigo = criarNoAmigo(idAmigo);
     // Adiciona o novo amigo no início da lista de amigos do usuário.
-    novoAmigo->proximo = usuario->listaAmigos;
-    usuario->listaAmigos = novoAmigo;
+    novoAmigo->proximo = rede->listaAmigos[idUsuario];
+    rede->listaAmigos[idUsuario] = novoAmigo;
+    atualizarIndiceSimilaridade(&rede->similaridade, idUsuario, idAmigo);
+    rede->versao++; // A rede mudou: avança a versão.
+    return true;
+}
+
+// Função que grava no arquivo todos os bytes acumulados no buffer do journal (sem fsync).
+void descarregarJournal(Journal* journal) {
+    size_t gravados = 0;
+    // Repete a escrita até todo o buffer ser gravado (write pode gravar apenas parte dos bytes).
+    while (gravados < journal->bytesNoBuffer) {
+        ssize_t n = write(journal->descritor, journal->buffer + gravados, journal->bytesNoBuffer - gravados);
+        if (n < 0) {
+            perror("Erro ao gravar o journal");
+            exit(EXIT_FAILURE);
+        }
+        gravados += (size_t)n;
+    }
+    journal->bytesNoBuffer = 0;
+}
+
+// Função que torna duráveis todas as operações pendentes do journal: grava o buffer e executa
+// um único fsync para o lote inteiro (group commit).
+void confirmarJournal(Journal* journal) {
+    if (journal->bytesNoBuffer == 0 && journal->operacoesPendentes == 0) return; // Nada pendente.
+    descarregarJournal(journal);
+    if (fsync(journal->descritor) != 0) {
+        perror("Erro ao sincronizar o journal");
+        exit(EXIT_FAILURE);
+    }
+    journal->operacoesPendentes = 0;
+}
+
+// Função que acrescenta um registro ao journal.
+// O registro só é gravado no disco quando o buffer enche ou quando o lote atinge LOTE_COMMIT_JOURNAL operações.
+void registrarNoJournal(Journal* journal, const unsigned char* registro, size_t tamanho) {
+    // Se o registro não cabe no buffer, grava o conteúdo atual antes de acrescentá-lo.
+    if (journal->bytesNoBuffer + tamanho > TAMANHO_BUFFER_JOURNAL) {
+        descarregarJournal(journal);
+    }
+    memcpy(journal->buffer + journal->bytesNoBuffer, registro, tamanho);
+    journal->bytesNoBuffer += tamanho;
+    journal->operacoesPendentes++;
+    journal->operacoesDesdeSnapshot++;
+    // Fecha o lote quando ele atinge o tamanho máximo.
+    if (journal->operacoesPendentes >= LOTE_COMMIT_JOURNAL) {
+        confirmarJournal(journal);
+    }
+}
+
+// Função que monta o registro de "usuário adicionado" e o acrescenta ao journal.
+void registrarUsuarioNoJournal(Journal* journal, int32_t id, const char* nome, uint8_t tamanhoNome) {
+    unsigned char registro[1 + sizeof(int32_t) + 1 + MAX_NOME_USUARIO];
+    registro[0] = OP_JOURNAL_USUARIO;
+    memcpy(registro + 1, &id, sizeof(int32_t));
+    registro[1 + sizeof(int32_t)] = tamanhoNome;
+    memcpy(registro + 2 + sizeof(int32_t), nome, tamanhoNome);
+    registrarNoJournal(journal, registro, 2 + sizeof(int32_t) + tamanhoNome);
+}
+
+// Função que monta o registro de "amizade criada" e o acrescenta ao journal.
+void registrarConexaoNoJournal(Journal* journal, int32_t id1, int32_t id2) {
+    unsigned char registro[1 + 2 * sizeof(int32_t)];
+    registro[0] = OP_JOURNAL_CONEXAO;
+    memcpy(registro + 1, &id1, sizeof(int32_t));
+    memcpy(registro + 1 + sizeof(int32_t), &id2, sizeof(int32_t));
+    registrarNoJournal(journal, registro, sizeof(registro));
 }
 
 // Função para criar e inicializar uma nova rede social.
@@ -87,23 +602,50 @@ RedeSocial* criarRedeSocial() {
         perror("Erro ao alocar memória para RedeSocial");
         exit(EXIT_FAILURE);
     }
-    // Inicializa cada usuário no array de usuários da rede.
+    // Define todos os usuários como inativos (zera o bitmap).
+    memset(rede->usuariosAtivos, 0, sizeof(rede->usuariosAtivos));
+    // Reserva a posição 0 da arena para a string vazia, compartilhada pelos slots sem nome.
+    rede->arenaNomes[0] = '\0';
+    rede->tamanhoArena = 1;
+    // Inicializa cada slot de usuário da rede (o ID do usuário é o próprio índice nos arrays).
     for (int i = 0; i < MAX_USUARIOS; i++) {
-        rede->usuarios[i].id = i;                         // Atribui um ID único ao usuário.
-        strcpy(rede->usuarios[i].nome, "");             // Inicializa o nome do usuário como uma string vazia.
-        rede->usuarios[i].listaAmigos = NULL;           // Inicializa a lista de amigos como vazia.
-        rede->usuarios[i].ativo = false;                  // Define o usuário como inativo.
+        rede->offsetNome[i] = 0;                        // Inicializa o nome do usuário como uma string vazia.
+        rede->listaAmigos[i] = NULL;                    // Inicializa a lista de amigos como vazia.
     }
     // Inicializa o contador de usuários ativos como 0.
     rede->numUsuariosAtivos = 0;
+    // Inicializa a versão dos dados.
+    rede->versao = 0;
+    // A rede começa sem journal; ele é associado depois que os dados persistidos forem carregados.
+    rede->journal = NULL;
+    // O índice de usuários similares começa vazio (ninguém tem amigos ainda).
+    inicializarIndiceSimilaridade(&rede->similaridade);
+    // O oráculo de distâncias só é construído sob demanda.
+    rede->oraculo = NULL;
     // Informa que a rede social foi inicializada.
     printf("Rede social inicializada.\n");
     // Retorna o ponteiro para a rede social criada.
     return rede;
 }
 
+// Função que ativa o slot 'id' com o nome fornecido (já limitado a 'tamanhoNome' caracteres).
+// Não faz validações nem imprime mensagens: é usada por adicionarUsuario e pela reprodução do journal.
+void ativarUsuario(RedeSocial* rede, int id, const char* nome, int tamanhoNome) {
+    marcarUsuarioAtivo(rede, id); // Ativa o usuário.
+    // Copia o nome para o fim da arena e termina com '\0'.
+    // Como cada slot é usado uma única vez, a arena nunca precisa de mais que TAMANHO_ARENA_NOMES bytes.
+    rede->offsetNome[id] = rede->tamanhoArena;
+    memcpy(&rede->arenaNomes[rede->tamanhoArena], nome, (size_t)tamanhoNome);
+    rede->arenaNomes[rede->tamanhoArena + tamanhoNome] = '\0'; // Garante a terminação nula.
+    rede->tamanhoArena += tamanhoNome + 1;
+    rede->listaAmigos[id] = NULL; // Inicializa a lista de amigos do novo usuário como vazia.
+    rede->numUsuariosAtivos++; // Incrementa o contador de usuários ativos.
+    rede->versao++; // A rede mudou: avança a versão.
+}
+
 // Função para adicionar um novo usuário à rede social.
 // Procura por um slot de usuário inativo, o ativa e atribui o nome fornecido.
+// Se a rede tiver um journal associado, a operação é registrada nele.
 // Retorna o ID do usuário adicionado ou -1 se a rede estiver cheia.
 int adicionarUsuario(RedeSocial* rede, const char* nome) {
     // Verifica se o número máximo de usuários foi atingido.
@@ -114,13 +656,15 @@ int adicionarUsuario(RedeSocial* rede, const char* nome) {
 
     // Procura por um slot de usuário inativo para adicionar o novo usuário.
     for (int i = 0; i < MAX_USUARIOS; i++) {
-        if (!rede->usuarios[i].ativo) { // Se encontrar um usuário inativo.
-            rede->usuarios[i].ativo = true; // Ativa o usuário.
-            // Copia o nome fornecido para o usuário, garantindo que não exceda o tamanho máximo e termine com '\0'.
-            strncpy(rede->usuarios[i].nome, nome, MAX_NOME_USUARIO - 1);
-            rede->usuarios[i].nome[MAX_NOME_USUARIO - 1] = '\0'; // Garante a terminação nula.
-            rede->usuarios[i].listaAmigos = NULL; // Inicializa a lista de amigos do novo usuário como vazia.
-            rede->numUsuariosAtivos++; // Incrementa o contador de usuários ativos.
+        if (!usuarioAtivo(rede, i)) { // Se encontrar um usuário inativo.
+            // Limita o nome ao tamanho máximo (o restante é descartado).
+            int tamanhoNome = 0;
+            while (tamanhoNome < MAX_NOME_USUARIO - 1 && nome[tamanhoNome] != '\0') tamanhoNome++;
+            ativarUsuario(rede, i, nome, tamanhoNome);
+            // Registra a operação no journal, se houver.
+            if (rede->journal != NULL) {
+                registrarUsuarioNoJournal(rede->journal, i, nome, (uint8_t)tamanhoNome);
+            }
             printf("Usuário '%s' (ID: %d) adicionado com sucesso.\n", nome, i);
             return i; // Retorna o ID do usuário adicionado.
         }
@@ -128,41 +672,324 @@ int adicionarUsuario(RedeSocial* rede, const char* nome) {
     return -1; // Caso (improvável, devido à verificação anterior) não encontre slot.
 }
 
-// Função para criar uma conexão (amizade) entre dois usuários.
-// Adiciona cada usuário à lista de amigos do outro.
-void criarConexao(RedeSocial* rede, int idUsuario1, int idUsuario2) {
+// Resultados de conectarUsuarios.
+#define CONEXAO_CRIADA 0              // A amizade foi criada (ou já existia).
+#define CONEXAO_USUARIO_INVALIDO 1    // Algum dos IDs é inválido ou de usuário inativo.
+#define CONEXAO_MESMO_USUARIO 2       // Os dois IDs são do mesmo usuário.
+
+// Cria a amizade entre dois usuários sem imprimir nada (usada pelo menu e pelo modo servidor).
+// Adiciona cada usuário à lista de amigos do outro e registra a amizade no journal, se houver.
+// Retorna CONEXAO_CRIADA ou o motivo da recusa.
+int conectarUsuarios(RedeSocial* rede, int idUsuario1, int idUsuario2) {
     // Verifica se os IDs dos usuários são válidos e se os usuários estão ativos.
-    if (idUsuario1 < 0 || idUsuario1 >= MAX_USUARIOS || !rede->usuarios[idUsuario1].ativo ||
-        idUsuario2 < 0 || idUsuario2 >= MAX_USUARIOS || !rede->usuarios[idUsuario2].ativo) {
-        printf("Erro: ID de usuário inválido ou usuário não ativo.\n");
-        return;
+    if (idUsuario1 < 0 || idUsuario1 >= MAX_USUARIOS || !usuarioAtivo(rede, idUsuario1) ||
+        idUsuario2 < 0 || idUsuario2 >= MAX_USUARIOS || !usuarioAtivo(rede, idUsuario2)) {
+        return CONEXAO_USUARIO_INVALIDO;
+    }
+    // Um usuário não pode ser amigo de si mesmo.
+    if (idUsuario1 == idUsuario2) return CONEXAO_MESMO_USUARIO;
+
+    // Adiciona a amizade na lista de ambos os usuários (conexão mútua).
+    // Só registra no journal as amizades novas, para que o journal não cresça com repetições.
+    bool nova = adicionarAmizadeNaLista(rede, idUsuario1, idUsuario2);
+    adicionarAmizadeNaLista(rede, idUsuario2, idUsuario1);
+    if (nova && rede->journal != NULL) {
+        registrarConexaoNoJournal(rede->journal, idUsuario1, idUsuario2);
     }
-    // Verifica se um usuário está tentando adicionar a si mesmo como amigo.
-    if (idUsuario1 == idUsuario2) {
+    return CONEXAO_CRIADA;
+}
+
+// Função para criar uma conexão (amizade) entre dois usuários e informar o resultado.
+void criarConexao(RedeSocial* rede, int idUsuario1, int idUsuario2) {
+    int resultado = conectarUsuarios(rede, idUsuario1, idUsuario2);
+    if (resultado == CONEXAO_USUARIO_INVALIDO) {
+        printf("Erro: ID de usuário inválido ou usuário não ativo.\n");
+    } else if (resultado == CONEXAO_MESMO_USUARIO) {
         printf("Erro: Um usuário não pode ser amigo de si mesmo.\n");
+    } else {
+        printf("Conexão criada entre %s (ID: %d) e %s (ID: %d).\n",
+               nomeUsuario(rede, idUsuario1), idUsuario1,
+               nomeUsuario(rede, idUsuario2), idUsuario2);
+    }
+}
+
+// Função que grava um arquivo inteiro e o torna durável (write + fsync), substituindo o conteúdo anterior.
+// Retorna true em caso de sucesso.
+bool gravarArquivoDuravel(const char* caminho, const unsigned char* dados, size_t tamanho) {
+    int descritor = open(caminho, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (descritor < 0) return false;
+    size_t gravados = 0;
+    while (gravados < tamanho) {
+        ssize_t n = write(descritor, dados + gravados, tamanho - gravados);
+        if (n < 0) { close(descritor); return false; }
+        gravados += (size_t)n;
+    }
+    bool ok = fsync(descritor) == 0;
+    close(descritor);
+    return ok;
+}
+
+// Função que compacta a persistência da rede: grava um snapshot com o estado atual
+// (cada usuário e cada amizade uma única vez) e esvazia o journal.
+// O snapshot é escrito em um arquivo temporário e depois renomeado, para que um arquivo
+// incompleto nunca substitua o anterior. Se o programa cair entre o rename e o esvaziamento
+// do journal, a reprodução simplesmente reaplica operações que já estão no snapshot, o que é
+// inofensivo (as operações são idempotentes).
+void salvarSnapshot(RedeSocial* rede) {
+    Journal* journal = rede->journal;
+    if (journal == NULL) return;
+
+    // Calcula o tamanho máximo do snapshot: cabeçalho, usuários e amizades (cada uma contada uma vez).
+    size_t capacidade = 4;
+    for (int i = 0; i < MAX_USUARIOS; i++) {
+        if (!usuarioAtivo(rede, i)) continue;
+        capacidade += 2 + sizeof(int32_t) + MAX_NOME_USUARIO;
+        for (NoAmigo* amigo = rede->listaAmigos[i]; amigo != NULL; amigo = amigo->proximo) {
+            capacidade += 1 + 2 * sizeof(int32_t);
+        }
+    }
+    unsigned char* dados = (unsigned char*)malloc(capacidade);
+    if (!dados) {
+        perror("Erro ao alocar memória para o snapshot");
+        exit(EXIT_FAILURE);
+    }
+
+    // Serializa o snapshot no mesmo formato de registros do journal.
+    size_t tamanho = 0;
+    memcpy(dados, MAGICO_SNAPSHOT, 4);
+    tamanho += 4;
+    // Primeiro todos os usuários, para que as amizades sempre encontrem os dois lados ativos.
+    for (int32_t i = 0; i < MAX_USUARIOS; i++) {
+        if (!usuarioAtivo(rede, i)) continue;
+        const char* nome = nomeUsuario(rede, i);
+        uint8_t tamanhoNome = (uint8_t)strlen(nome);
+        dados[tamanho++] = OP_JOURNAL_USUARIO;
+        memcpy(dados + tamanho, &i, sizeof(int32_t));
+        tamanho += sizeof(int32_t);
+        dados[tamanho++] = tamanhoNome;
+        memcpy(dados + tamanho, nome, tamanhoNome);
+        tamanho += tamanhoNome;
+    }
+    // Depois as amizades, gravando cada par apenas a partir do menor ID.
+    for (int32_t i = 0; i < MAX_USUARIOS; i++) {
+        if (!usuarioAtivo(rede, i)) continue;
+        for (NoAmigo* amigo = rede->listaAmigos[i]; amigo != NULL; amigo = amigo->proximo) {
+            int32_t j = amigo->idUsuario;
+            if (j <= i) continue;
+            dados[tamanho++] = OP_JOURNAL_CONEXAO;
+            memcpy(dados + tamanho, &i, sizeof(int32_t));
+            memcpy(dados + tamanho + sizeof(int32_t), &j, sizeof(int32_t));
+            tamanho += 2 * sizeof(int32_t);
+        }
+    }
+
+    // Grava o snapshot em um arquivo temporário e o renomeia sobre o anterior (troca atômica).
+    if (!gravarArquivoDuravel(ARQUIVO_SNAPSHOT ".tmp", dados, tamanho) ||
+        rename(ARQUIVO_SNAPSHOT ".tmp", ARQUIVO_SNAPSHOT) != 0) {
+        perror("Erro ao gravar o snapshot da rede social");
+        free(dados);
+        return; // Mantém o journal intacto: nenhuma operação é perdida.
+    }
+    free(dados);
+
+    // O snapshot já contém tudo: descarta o que estiver no buffer e esvazia o journal, mantendo só o cabeçalho.
+    journal->bytesNoBuffer = 0;
+    journal->operacoesPendentes = 0;
+    journal->operacoesDesdeSnapshot = 0;
+    if (ftruncate(journal->descritor, 4) != 0 || fsync(journal->descritor) != 0) {
+        perror("Erro ao esvaziar o journal");
+        exit(EXIT_FAILURE);
+    }
+    lseek(journal->descritor, 0, SEEK_END);
+}
+
+// Função que confirma as operações pendentes do journal da rede (um fsync para o lote todo)
+// e, se o journal já acumulou operações demais, o compacta em um novo snapshot.
+void sincronizarPersistencia(RedeSocial* rede) {
+    if (rede->journal == NULL) return;
+    confirmarJournal(rede->journal);
+    if (rede->journal->operacoesDesdeSnapshot >= LIMITE_OPERACOES_SNAPSHOT) {
+        salvarSnapshot(rede);
+    }
+}
+
+// Função usada pelo group commit do modo servidor, sob a trava das escritas: grava no arquivo os
+// registros do buffer (sem fsync), encerra o lote e compacta o journal se ele acumulou operações demais.
+// Retorna o descritor em que o chamador fará o fsync já fora da trava (-1 se a rede não tem journal ou
+// se não há nada pendente: as operações anteriores já foram confirmadas pelo lote anterior).
+int prepararConfirmacaoJournal(RedeSocial* rede) {
+    Journal* journal = rede->journal;
+    if (journal == NULL || (journal->bytesNoBuffer == 0 && journal->operacoesPendentes == 0)) return -1;
+    descarregarJournal(journal);
+    journal->operacoesPendentes = 0;
+    if (journal->operacoesDesdeSnapshot >= LIMITE_OPERACOES_SNAPSHOT) salvarSnapshot(rede);
+    return journal->descritor;
+}
+
+// Função que aplica à rede um registro lido do journal ou do snapshot.
+// Registros inválidos ou já aplicados são ignorados, o que torna a reprodução idempotente.
+void aplicarRegistro(RedeSocial* rede, const unsigned char* registro) {
+    int32_t id1, id2;
+    memcpy(&id1, registro + 1, sizeof(int32_t));
+    if (registro[0] == OP_JOURNAL_USUARIO) {
+        if (id1 >= 0 && id1 < MAX_USUARIOS && !usuarioAtivo(rede, id1)) {
+            int tamanhoNome = registro[1 + sizeof(int32_t)];
+            if (tamanhoNome > MAX_NOME_USUARIO - 1) tamanhoNome = MAX_NOME_USUARIO - 1;
+            ativarUsuario(rede, id1, (const char*)registro + 2 + sizeof(int32_t), tamanhoNome);
+        }
+    } else {
+        memcpy(&id2, registro + 1 + sizeof(int32_t), sizeof(int32_t));
+        if (id1 >= 0 && id1 < MAX_USUARIOS && usuarioAtivo(rede, id1) &&
+            id2 >= 0 && id2 < MAX_USUARIOS && usuarioAtivo(rede, id2) && id1 != id2) {
+            adicionarAmizadeNaLista(rede, id1, id2);
+            adicionarAmizadeNaLista(rede, id2, id1);
+        }
+    }
+}
+
+// Função que reproduz (replay) um arquivo de journal ou snapshot sobre a rede, em uma única passada.
+// O arquivo é lido em blocos grandes e os registros são decodificados diretamente do buffer;
+// um registro que atravessa o fim do bloco é movido para o início antes da próxima leitura.
+// Retorna o número de bytes válidos do arquivo (até o último registro completo: só um registro final
+// incompleto, de uma queda no meio de uma gravação, fica de fora), ARQUIVO_AUSENTE ou ARQUIVO_CORROMPIDO.
+// Na corrupção os registros anteriores a ela já foram aplicados e o erro é informado.
+// '*operacoes' recebe a quantidade de registros lidos.
+long reproduzirArquivo(RedeSocial* rede, const char* caminho, const char* magico, long* operacoes) {
+    *operacoes = 0;
+    FILE* arquivo = fopen(caminho, "rb");
+    if (arquivo == NULL) return ARQUIVO_AUSENTE;
+    char cabecalho[4];
+    if (fread(cabecalho, 1, 4, arquivo) != 4) {
+        fclose(arquivo);
+        return ARQUIVO_AUSENTE; // Queda antes de o cabeçalho ser gravado: não há registros.
+    }
+    if (memcmp(cabecalho, magico, 4) != 0) {
+        printf("Erro: o arquivo %s não tem o cabeçalho esperado.\n", caminho);
+        fclose(arquivo);
+        return ARQUIVO_CORROMPIDO;
+    }
+
+    unsigned char* bloco = (unsigned char*)malloc(TAMANHO_BLOCO_REPLAY);
+    if (!bloco) {
+        perror("Erro ao alocar memória para a reprodução do journal");
+        exit(EXIT_FAILURE);
+    }
+    long bytesValidos = 4;     // Posição no arquivo logo após o último registro completo.
+    size_t noBloco = 0;        // Bytes ocupados no bloco.
+    bool corrompido = false;   // Indica que um código de operação desconhecido foi encontrado.
+    size_t lidos;
+    while (!corrompido && (lidos = fread(bloco + noBloco, 1, TAMANHO_BLOCO_REPLAY - noBloco, arquivo)) > 0) {
+        noBloco += lidos;
+        size_t pos = 0;
+        // Decodifica todos os registros completos presentes no bloco.
+        while (pos < noBloco) {
+            size_t tamanhoRegistro;
+            if (bloco[pos] == OP_JOURNAL_CONEXAO) {
+                tamanhoRegistro = 1 + 2 * sizeof(int32_t);
+            } else if (bloco[pos] == OP_JOURNAL_USUARIO) {
+                if (pos + 2 + sizeof(int32_t) > noBloco) break; // Cabeçalho do registro incompleto.
+                tamanhoRegistro = 2 + sizeof(int32_t) + bloco[pos + 1 + sizeof(int32_t)];
+            } else {
+                printf("Erro: o arquivo %s está corrompido na posição %ld (código de operação %u desconhecido).\n",
+                       caminho, bytesValidos, (unsigned)bloco[pos]);
+                corrompido = true;
+                break;
+            }
+            if (pos + tamanhoRegistro > noBloco) break; // Registro incompleto: termina no próximo bloco.
+            aplicarRegistro(rede, bloco + pos);
+            pos += tamanhoRegistro;
+            bytesValidos += (long)tamanhoRegistro;
+            (*operacoes)++;
+        }
+        // Move o registro incompleto (se houver) para o início do bloco.
+        memmove(bloco, bloco + pos, noBloco - pos);
+        noBloco -= pos;
+    }
+    free(bloco);
+    fclose(arquivo);
+    return corrompido ? ARQUIVO_CORROMPIDO : bytesValidos;
+}
+
+// Função que carrega o estado persistido da rede: reproduz o snapshot e, em seguida, o journal.
+// Deve ser chamada antes de associar o journal à rede, para que a reprodução não seja registrada novamente.
+// Retorna o tamanho válido do journal em bytes, ARQUIVO_AUSENTE ou ARQUIVO_CORROMPIDO (também quando
+// o snapshot está corrompido, já que a próxima compactação o substituiria por um estado incompleto) e
+// preenche '*operacoesNoJournal' com a quantidade de operações ainda não compactadas.
+long carregarRedeSocial(RedeSocial* rede, long* operacoesNoJournal) {
+    long operacoesSnapshot, operacoesJournal;
+    long tamanhoSnapshot = reproduzirArquivo(rede, ARQUIVO_SNAPSHOT, MAGICO_SNAPSHOT, &operacoesSnapshot);
+    long tamanhoJournal = reproduzirArquivo(rede, ARQUIVO_JOURNAL, MAGICO_JOURNAL, &operacoesJournal);
+    if (tamanhoSnapshot == ARQUIVO_CORROMPIDO) tamanhoJournal = ARQUIVO_CORROMPIDO;
+    if (operacoesSnapshot + operacoesJournal > 0) {
+        printf("Rede social carregada do disco: %ld operações do snapshot e %ld do journal.\n",
+               operacoesSnapshot, operacoesJournal);
+    }
+    *operacoesNoJournal = operacoesJournal;
+    return tamanhoJournal;
+}
+
+// Função que abre o journal para anexação e o associa à rede.
+// 'tamanhoValido' e 'operacoesNoJournal' vêm de carregarRedeSocial: um registro final incompleto (por
+// exemplo, de uma queda no meio de uma gravação) é descartado truncando o arquivo nesse ponto. Com um
+// arquivo corrompido o journal não é aberto: a execução segue sem persistência e os arquivos ficam
+// intactos, para que nenhuma operação posterior à corrupção seja apagada.
+void abrirJournal(RedeSocial* rede, long tamanhoValido, long operacoesNoJournal) {
+    if (tamanhoValido == ARQUIVO_CORROMPIDO) {
+        printf("Aviso: persistência desativada nesta execução; os arquivos %s e %s não serão alterados.\n"
+               "Corrija-os ou mova-os para outro lugar para voltar a registrar as operações.\n",
+               ARQUIVO_SNAPSHOT, ARQUIVO_JOURNAL);
         return;
     }
+    Journal* journal = (Journal*)malloc(sizeof(Journal));
+    if (!journal) {
+        perror("Erro ao alocar memória para o journal");
+        exit(EXIT_FAILURE);
+    }
+    journal->descritor = open(ARQUIVO_JOURNAL, O_WRONLY | O_CREAT, 0644);
+    if (journal->descritor < 0) {
+        perror("Erro ao abrir o journal");
+        free(journal);
+        return; // Segue sem persistência.
+    }
+    journal->bytesNoBuffer = 0;
+    journal->operacoesPendentes = 0;
+    journal->operacoesDesdeSnapshot = tamanhoValido == ARQUIVO_AUSENTE ? 0 : operacoesNoJournal;
+    if (tamanhoValido == ARQUIVO_AUSENTE) {
+        // Journal inexistente (ou sem cabeçalho completo): recomeça com apenas o cabeçalho.
+        if (ftruncate(journal->descritor, 0) != 0 ||
+            write(journal->descritor, MAGICO_JOURNAL, 4) != 4) {
+            perror("Erro ao inicializar o journal");
+            exit(EXIT_FAILURE);
+        }
+    } else if (ftruncate(journal->descritor, tamanhoValido) != 0) {
+        perror("Erro ao truncar o journal");
+        exit(EXIT_FAILURE);
+    }
+    lseek(journal->descritor, 0, SEEK_END);
+    rede->journal = journal;
+}
 
-    // Adiciona a amizade na lista de ambos os usuários (conexão mútua).
-    adicionarAmizadeNaLista(&rede->usuarios[idUsuario1], idUsuario2);
-    adicionarAmizadeNaLista(&rede->usuarios[idUsuario2], idUsuario1);
-    printf("Conexão criada entre %s (ID: %d) e %s (ID: %d).\n",
-           rede->usuarios[idUsuario1].nome, idUsuario1,
-           rede->usuarios[idUsuario2].nome, idUsuario2);
+// Função que confirma as operações pendentes, fecha o journal e o desassocia da rede.
+void fecharJournal(RedeSocial* rede) {
+    if (rede->journal == NULL) return;
+    confirmarJournal(rede->journal);
+    close(rede->journal->descritor);
+    free(rede->journal);
+    rede->journal = NULL;
 }
 
 // Função para visualizar a lista de amigos de um usuário específico.
 void visualizarRedeAmizades(RedeSocial* rede, int idUsuario) {
     // Verifica se o ID do usuário é válido e se o usuário está ativo.
-    if (idUsuario < 0 || idUsuario >= MAX_USUARIOS || !rede->usuarios[idUsuario].ativo) {
+    if (idUsuario < 0 || idUsuario >= MAX_USUARIOS || !usuarioAtivo(rede, idUsuario)) {
         printf("Erro: ID de usuário inválido ou usuário não ativo.\n");
         return;
     }
 
     // Exibe o nome e ID do usuário cujos amigos serão listados.
-    printf("Amigos de %s (ID: %d):\n", rede->usuarios[idUsuario].nome, idUsuario);
+    printf("Amigos de %s (ID: %d):\n", nomeUsuario(rede, idUsuario), idUsuario);
     // Percorre a lista de amigos do usuário.
-    NoAmigo* amigoAtual = rede->usuarios[idUsuario].listaAmigos;
+    NoAmigo* amigoAtual = rede->listaAmigos[idUsuario];
     // Verifica se o usuário não tem amigos.
     if (amigoAtual == NULL) {
         printf("  Nenhum amigo encontrado.\n");
@@ -170,86 +997,215 @@ void visualizarRedeAmizades(RedeSocial* rede, int idUsuario) {
     }
     // Itera sobre a lista de amigos e imprime o nome e ID de cada amigo.
     while (amigoAtual != NULL) {
-        printf("  - %s (ID: %d)\n", rede->usuarios[amigoAtual->idUsuario].nome, amigoAtual->idUsuario);
+        printf("  - %s (ID: %d)\n", nomeUsuario(rede, amigoAtual->idUsuario), amigoAtual->idUsuario);
         amigoAtual = amigoAtual->proximo;
     }
 }
 
-// Função para realizar uma Busca em Largura (BFS) na rede social a partir de um usuário inicial.
-// Mostra os usuários alcançáveis e a distância (nível) em relação ao usuário inicial.
-void BFS(RedeSocial* rede, int idUsuarioInicio) {
-    // Verifica se o ID do usuário inicial é válido e se ele está ativo.
-    if (idUsuarioInicio < 0 || idUsuarioInicio >= MAX_USUARIOS || !rede->usuarios[idUsuarioInicio].ativo) {
-        printf("Erro: ID de usuário inicial inválido para BFS.\n");
-        return;
+// Define a área de trabalho reutilizável das travessias (BFS, DFS, sugestões, conectividade e distâncias).
+// Em vez de limpar arrays de MAX_USUARIOS posições a cada consulta, cada usuário visitado recebe a marca
+// da geração atual: reiniciar a área só avança 'geracao' (O(1)), e as entradas com marca antiga valem
+// como não visitadas. Assim o custo de uma consulta é proporcional à região que ela visita.
+// Uma área atende uma consulta por vez; por padrão cada thread usa a sua (areaTrabalhoDaThread).
+typedef struct AreaTrabalho {
+    uint32_t geracao;                      // Geração da consulta atual.
+    int numTocados;                        // Usuários marcados na consulta atual.
+    uint32_t geracaoVisita[MAX_USUARIOS];  // geracaoVisita[u] == geracao: u foi visitado nesta consulta.
+    int distancia[MAX_USUARIOS];           // Nível de cada usuário visitado (só vale para os visitados).
+    int fila[MAX_USUARIOS];                // Fila da BFS ou pilha da DFS iterativa.
+} AreaTrabalho;
+
+// Bytes da área escritos por usuário visitado (para as estatísticas de memória de trabalho).
+#define BYTES_AREA_POR_USUARIO (sizeof(uint32_t) + 2 * sizeof(int))
+
+// Função que cria uma área de trabalho sem nenhum usuário visitado.
+AreaTrabalho* criarAreaTrabalho() {
+    AreaTrabalho* area = (AreaTrabalho*)malloc(sizeof(AreaTrabalho));
+    if (!area) {
+        perror("Erro ao alocar memória para a área de trabalho");
+        exit(EXIT_FAILURE);
+    }
+    memset(area->geracaoVisita, 0, sizeof(area->geracaoVisita));
+    area->geracao = 0;
+    area->numTocados = 0;
+    return area;
+}
+
+// Função que libera uma área de trabalho.
+void liberarAreaTrabalho(AreaTrabalho* area) {
+    free(area);
+}
+
+// Prepara a área para uma nova consulta, esquecendo todas as visitas da anterior em O(1).
+static inline void reiniciarAreaTrabalho(AreaTrabalho* area) {
+    // Quando o contador dá a volta (a cada 2^32 consultas), marcas antigas poderiam coincidir com a
+    // geração nova: só nesse caso as marcas são limpas de fato.
+    if (++area->geracao == 0) {
+        memset(area->geracaoVisita, 0, sizeof(area->geracaoVisita));
+        area->geracao = 1;
+    }
+    area->numTocados = 0;
+}
+
+// Retorna true se o usuário já foi visitado na consulta atual da área.
+static inline bool usuarioVisitado(const AreaTrabalho* area, int id) {
+    return area->geracaoVisita[id] == area->geracao;
+}
+
+// Marca o usuário (ainda não visitado) como visitado na consulta atual da área.
+static inline void marcarVisitado(AreaTrabalho* area, int id) {
+    area->geracaoVisita[id] = area->geracao;
+    area->numTocados++;
+}
+
+// Retorna o nível do usuário na última BFS feita com a área (-1 se ele não foi alcançado).
+static inline int distanciaNaArea(const AreaTrabalho* area, int id) {
+    return usuarioVisitado(area, id) ? area->distancia[id] : -1;
+}
+
+// Chave da área de trabalho de cada thread, criada uma única vez.
+static pthread_key_t chaveAreaTrabalho;
+static pthread_once_t chaveAreaTrabalhoCriada = PTHREAD_ONCE_INIT;
+
+// Destrutor chamado quando uma thread que usou a sua área termina.
+static void destruirAreaTrabalhoDaThread(void* area) {
+    liberarAreaTrabalho((AreaTrabalho*)area);
+}
+
+static void criarChaveAreaTrabalho(void) {
+    pthread_key_create(&chaveAreaTrabalho, destruirAreaTrabalhoDaThread);
+}
+
+// Retorna a área de trabalho da thread chamadora, criando-a no primeiro uso. É a área usada quando
+// uma travessia recebe NULL, e é liberada automaticamente quando a thread termina.
+AreaTrabalho* areaTrabalhoDaThread() {
+    pthread_once(&chaveAreaTrabalhoCriada, criarChaveAreaTrabalho);
+    AreaTrabalho* area = (AreaTrabalho*)pthread_getspecific(chaveAreaTrabalho);
+    if (area == NULL) {
+        area = criarAreaTrabalho();
+        pthread_setspecific(chaveAreaTrabalho, area);
     }
+    return area;
+}
 
-    printf("\n--- BFS a partir de %s (ID: %d) ---\n", rede->usuarios[idUsuarioInicio].nome, idUsuarioInicio);
+// Libera a área de trabalho da thread chamadora, se houver (a thread principal não passa pelo
+// destrutor ao sair de main).
+void liberarAreaTrabalhoDaThread() {
+    pthread_once(&chaveAreaTrabalhoCriada, criarChaveAreaTrabalho);
+    liberarAreaTrabalho((AreaTrabalho*)pthread_getspecific(chaveAreaTrabalho));
+    pthread_setspecific(chaveAreaTrabalho, NULL);
+}
 
-    // Array para marcar os usuários visitados durante a BFS.
-    bool visitado[MAX_USUARIOS] = {false};
-    // Fila para gerenciar os usuários a serem visitados.
-    int fila[MAX_USUARIOS];
-    // Índices para o início e fim da fila.
+// Função que executa a Busca em Largura (BFS) a partir de um usuário sem imprimir nada.
+// Reinicia 'area' (NULL: a área da thread chamadora) e deixa nela o resultado: 'area->fila' recebe os
+// usuários alcançados, na ordem em que foram descobertos (o array também serve de fila), e
+// distanciaNaArea dá o nível de cada usuário (-1 para os não alcançados).
+// O ID inicial deve ser válido e ativo. Se 'estatisticas' não for NULL, preenche-o com os contadores,
+// a fronteira de cada nível e os tempos desta consulta.
+// Retorna a quantidade de usuários alcançados (incluindo o inicial).
+int BFSNiveis(const RedeSocial* rede, int idUsuarioInicio, AreaTrabalho* area, EstatisticasConsulta* estatisticas) {
+    if (area == NULL) area = areaTrabalhoDaThread();
+    int* ordem = area->fila;
+    int* distancia = area->distancia;
+    // Índices para o início e fim da fila (a fila é o próprio array 'ordem').
     int inicioFila = 0, fimFila = 0;
-    // Array para armazenar a distância de cada usuário em relação ao usuário inicial.
-    int distancia[MAX_USUARIOS];
+    double marca = iniciarEstatisticas(estatisticas, 0);
 
-    // Inicializa as distâncias de todos os usuários como -1 (não alcançado).
-    for(int i=0; i<MAX_USUARIOS; i++) distancia[i] = -1;
+    // Esquece as visitas da consulta anterior (nenhum usuário fica marcado como visitado).
+    reiniciarAreaTrabalho(area);
 
-    // Adiciona o usuário inicial à fila, marca como visitado e define sua distância como 0.
-    fila[fimFila++] = idUsuarioInicio;
-    visitado[idUsuarioInicio] = true;
+    // Adiciona o usuário inicial à fila, marca-o como visitado e define sua distância como 0.
+    ordem[fimFila++] = idUsuarioInicio;
+    marcarVisitado(area, idUsuarioInicio);
     distancia[idUsuarioInicio] = 0;
-
-    printf("Usuários alcançáveis e suas distâncias (níveis):\n");
-    printf("  %s (ID: %d) - Nível 0 (você mesmo)\n", rede->usuarios[idUsuarioInicio].nome, idUsuarioInicio);
+    CONTAR_ESTATISTICA(estatisticas, insercoesFila, 1);
+    contarFronteira(estatisticas, 0);
+    encerrarFase(estatisticas, FASE_INICIALIZACAO, &marca);
 
     // Loop principal da BFS: continua enquanto a fila não estiver vazia.
     while (inicioFila < fimFila) {
         // Remove o primeiro usuário da fila (FIFO).
-        int idUsuarioAtual = fila[inicioFila++];
+        int idUsuarioAtual = ordem[inicioFila++];
+        CONTAR_ESTATISTICA(estatisticas, remocoesFila, 1);
+        CONTAR_ESTATISTICA(estatisticas, verticesFixados, 1);
 
         // Percorre a lista de amigos do usuário atual.
-        NoAmigo* amigo = rede->usuarios[idUsuarioAtual].listaAmigos;
+        NoAmigo* amigo = rede->listaAmigos[idUsuarioAtual];
         while (amigo != NULL) {
             int idVizinho = amigo->idUsuario;
+            CONTAR_ESTATISTICA(estatisticas, arestasInspecionadas, 1);
             // Se o vizinho estiver ativo e não tiver sido visitado ainda.
-            if (rede->usuarios[idVizinho].ativo && !visitado[idVizinho]) {
-                visitado[idVizinho] = true; // Marca como visitado.
+            if (usuarioAtivo(rede, idVizinho) && !usuarioVisitado(area, idVizinho)) {
+                marcarVisitado(area, idVizinho);
                 distancia[idVizinho] = distancia[idUsuarioAtual] + 1; // Calcula a distância.
-                fila[fimFila++] = idVizinho; // Adiciona à fila para visita futura.
-                printf("  %s (ID: %d) - Nível %d\n", rede->usuarios[idVizinho].nome, idVizinho, distancia[idVizinho]);
+                ordem[fimFila++] = idVizinho; // Adiciona à fila para visita futura.
+                CONTAR_ESTATISTICA(estatisticas, arestasRelaxadas, 1);
+                CONTAR_ESTATISTICA(estatisticas, insercoesFila, 1);
+                contarFronteira(estatisticas, distancia[idVizinho]);
             }
             amigo = amigo->proximo; // Move para o próximo amigo.
         }
     }
+    CONTAR_ESTATISTICA(estatisticas, bytesAlocados, (long)((size_t)area->numTocados * BYTES_AREA_POR_USUARIO));
+    encerrarFase(estatisticas, FASE_BUSCA, &marca);
+    // Ao final, todos os usuários que passaram pela fila foram alcançados.
+    return fimFila;
+}
+
+// Função para realizar uma Busca em Largura (BFS) na rede social a partir de um usuário inicial.
+// Mostra os usuários alcançáveis e a distância (nível) em relação ao usuário inicial.
+void BFS(RedeSocial* rede, int idUsuarioInicio) {
+    // Verifica se o ID do usuário inicial é válido e se ele está ativo.
+    if (idUsuarioInicio < 0 || idUsuarioInicio >= MAX_USUARIOS || !usuarioAtivo(rede, idUsuarioInicio)) {
+        printf("Erro: ID de usuário inicial inválido para BFS.\n");
+        return;
+    }
+
+    printf("\n--- BFS a partir de %s (ID: %d) ---\n", nomeUsuario(rede, idUsuarioInicio), idUsuarioInicio);
+
+    // Usuários alcançados, na ordem de descoberta, e a distância de cada um ficam na área da thread.
+    AreaTrabalho* area = areaTrabalhoDaThread();
+    // Com "--estatisticas", coleta os contadores da consulta, mostra-os e soma-os ao agregado do menu.
+    EstatisticasConsulta estatisticas;
+    int alcancados = BFSNiveis(rede, idUsuarioInicio, area, estatisticasAtivas ? &estatisticas : NULL);
+
+    printf("Usuários alcançáveis e suas distâncias (níveis):\n");
+    printf("  %s (ID: %d) - Nível 0 (você mesmo)\n", nomeUsuario(rede, idUsuarioInicio), idUsuarioInicio);
+    // Imprime os demais usuários na ordem em que foram descobertos.
+    for (int i = 1; i < alcancados; i++) {
+        int id = area->fila[i];
+        printf("  %s (ID: %d) - Nível %d\n", nomeUsuario(rede, id), id, area->distancia[id]);
+    }
+    if (estatisticasAtivas) {
+        imprimirEstatisticas(&estatisticas);
+        acumularEstatisticas(&agregadosMenu[ESTATISTICAS_BFS], &estatisticas);
+    }
 }
 
 // Função utilitária recursiva para a Busca em Profundidade (DFS).
 // Visita um usuário, marca-o como visitado e, opcionalmente, o adiciona a um grupo.
 // Em seguida, chama recursivamente para todos os vizinhos não visitados.
-void DFSUtil(RedeSocial* rede, int idUsuario, bool visitado[], int* grupo, int* contadorGrupo) {
+// As visitas são marcadas em 'area', que o chamador reinicia (reiniciarAreaTrabalho) antes da primeira chamada.
+void DFSUtil(const RedeSocial* rede, int idUsuario, AreaTrabalho* area, int* grupo, int* contadorGrupo) {
     // Marca o usuário atual como visitado.
-    visitado[idUsuario] = true;
+    marcarVisitado(area, idUsuario);
     // Se os ponteiros 'grupo' e 'contadorGrupo' não forem NULL, adiciona o usuário ao grupo.
     // Isso é usado pela função explorarGrupos.
     if (grupo != NULL && contadorGrupo != NULL) {
         grupo[(*contadorGrupo)++] = idUsuario;
     } else {
         // Caso contrário (chamado diretamente pela DFS), apenas imprime que está visitando.
-         printf("  Visitando %s (ID: %d)\n", rede->usuarios[idUsuario].nome, idUsuario);
+         printf("  Visitando %s (ID: %d)\n", nomeUsuario(rede, idUsuario), idUsuario);
     }
 
     // Percorre a lista de amigos do usuário atual.
-    NoAmigo* amigo = rede->usuarios[idUsuario].listaAmigos;
+    NoAmigo* amigo = rede->listaAmigos[idUsuario];
     while (amigo != NULL) {
         int idVizinho = amigo->idUsuario;
         // Se o vizinho estiver ativo e não tiver sido visitado.
-        if (rede->usuarios[idVizinho].ativo && !visitado[idVizinho]) {
+        if (usuarioAtivo(rede, idVizinho) && !usuarioVisitado(area, idVizinho)) {
             // Chama recursivamente a DFSUtil para o vizinho.
-            DFSUtil(rede, idVizinho, visitado, grupo, contadorGrupo);
+            DFSUtil(rede, idVizinho, area, grupo, contadorGrupo);
         }
         amigo = amigo->proximo; // Move para o próximo amigo.
     }
@@ -258,116 +1214,1037 @@ void DFSUtil(RedeSocial* rede, int idUsuario, bool visitado[], int* grupo, int*
 // Função principal para realizar uma Busca em Profundidade (DFS) na rede social a partir de um usuário inicial.
 void DFS(RedeSocial* rede, int idUsuarioInicio) {
     // Verifica se o ID do usuário inicial é válido e se ele está ativo.
-    if (idUsuarioInicio < 0 || idUsuarioInicio >= MAX_USUARIOS || !rede->usuarios[idUsuarioInicio].ativo) {
+    if (idUsuarioInicio < 0 || idUsuarioInicio >= MAX_USUARIOS || !usuarioAtivo(rede, idUsuarioInicio)) {
         printf("Erro: ID de usuário inicial inválido para DFS.\n");
         return;
     }
 
-    printf("\n--- DFS a partir de %s (ID: %d) ---\n", rede->usuarios[idUsuarioInicio].nome, idUsuarioInicio);
-    // Array para marcar os usuários visitados durante a DFS.
-    bool visitado[MAX_USUARIOS] = {false};
+    printf("\n--- DFS a partir de %s (ID: %d) ---\n", nomeUsuario(rede, idUsuarioInicio), idUsuarioInicio);
+    // Os usuários visitados durante a DFS são marcados na área da thread, reiniciada em O(1).
+    AreaTrabalho* area = areaTrabalhoDaThread();
+    reiniciarAreaTrabalho(area);
     // Chama a função utilitária DFSUtil para iniciar a busca.
     // Passa NULL para 'grupo' e 'contadorGrupo' pois aqui o objetivo é apenas mostrar a ordem de visitação.
-    DFSUtil(rede, idUsuarioInicio, visitado, NULL, NULL);
+    DFSUtil(rede, idUsuarioInicio, area, NULL, NULL);
 }
 
-// Função para sugerir amigos a um usuário.
-// Sugere amigos de amigos que ainda não são amigos diretos do usuário.
-void sugerirAmigos(RedeSocial* rede, int idUsuario) {
-    // Verifica se o ID do usuário é válido e se ele está ativo.
-    if (idUsuario < 0 || idUsuario >= MAX_USUARIOS || !rede->usuarios[idUsuario].ativo) {
-        printf("Erro: ID de usuário inválido para sugestão de amigos.\n");
-        return;
-    }
-
-    printf("\n--- Sugestões de Amigos para %s (ID: %d) ---\n", rede->usuarios[idUsuario].nome, idUsuario);
-
-    // Array para marcar quem já é amigo direto ou o próprio usuário (para não sugerir).
-    bool ehAmigoDireto[MAX_USUARIOS] = {false};
-    // Marca o próprio usuário para não ser sugerido.
-    ehAmigoDireto[idUsuario] = true;
+// Função que calcula as sugestões de amigos de um usuário sem imprimir nada.
+// Sugere amigos de amigos que ainda não são amigos diretos do usuário: 'sugestoes[i]' recebe o
+// ID do usuário sugerido e 'intermediarios[i]' o ID do amigo em comum pelo qual ele foi encontrado.
+// 'area' (NULL: a área da thread chamadora) marca quem já é amigo direto ou já foi sugerido.
+// O ID deve ser válido e ativo. Se 'estatisticas' não for NULL, preenche-o com os contadores desta
+// consulta (nível 1 da fronteira: amigos diretos; nível 2: sugestões). Retorna a quantidade de sugestões.
+int calcularSugestoes(const RedeSocial* rede, int idUsuario, int sugestoes[], int intermediarios[],
+                      AreaTrabalho* area, EstatisticasConsulta* estatisticas) {
+    if (area == NULL) area = areaTrabalhoDaThread();
+    double marca = iniciarEstatisticas(estatisticas, 0);
+    // Marca quem já é amigo direto ou o próprio usuário (para não sugerir); começa pelo próprio usuário.
+    reiniciarAreaTrabalho(area);
+    marcarVisitado(area, idUsuario);
+    contarFronteira(estatisticas, 0);
 
     // Percorre a lista de amigos diretos do usuário e marca-os.
-    NoAmigo* amigoAtual = rede->usuarios[idUsuario].listaAmigos;
+    NoAmigo* amigoAtual = rede->listaAmigos[idUsuario];
     while (amigoAtual != NULL) {
-        ehAmigoDireto[amigoAtual->idUsuario] = true;
+        if (!usuarioVisitado(area, amigoAtual->idUsuario)) marcarVisitado(area, amigoAtual->idUsuario);
+        CONTAR_ESTATISTICA(estatisticas, arestasInspecionadas, 1);
+        contarFronteira(estatisticas, 1);
         amigoAtual = amigoAtual->proximo;
     }
+    encerrarFase(estatisticas, FASE_INICIALIZACAO, &marca);
 
     int sugestoesEncontradas = 0; // Contador de sugestões.
 
     // Itera sobre os amigos do usuário (amigos de nível 1).
-    amigoAtual = rede->usuarios[idUsuario].listaAmigos;
+    amigoAtual = rede->listaAmigos[idUsuario];
     while (amigoAtual != NULL) {
         int idAmigoNivel1 = amigoAtual->idUsuario; // ID de um amigo direto.
         // Pula se o amigo de nível 1 não estiver ativo (embora improvável se for amigo).
-        if (!rede->usuarios[idAmigoNivel1].ativo) {
+        if (!usuarioAtivo(rede, idAmigoNivel1)) {
             amigoAtual = amigoAtual->proximo;
             continue;
         }
 
         // Itera sobre os amigos do amigo de nível 1 (amigos de nível 2).
-        NoAmigo* amigoDoAmigo = rede->usuarios[idAmigoNivel1].listaAmigos;
+        CONTAR_ESTATISTICA(estatisticas, verticesFixados, 1);
+        NoAmigo* amigoDoAmigo = rede->listaAmigos[idAmigoNivel1];
         while (amigoDoAmigo != NULL) {
             int idAmigoNivel2 = amigoDoAmigo->idUsuario; // ID de um amigo do amigo.
+            CONTAR_ESTATISTICA(estatisticas, arestasInspecionadas, 1);
             // Se o amigo de nível 2 estiver ativo e NÃO for amigo direto (nem o próprio usuário).
-            if (rede->usuarios[idAmigoNivel2].ativo && !ehAmigoDireto[idAmigoNivel2]) {
-                printf("  - %s (ID: %d) (amigo de %s)\n",
-                       rede->usuarios[idAmigoNivel2].nome, idAmigoNivel2,
-                       rede->usuarios[idAmigoNivel1].nome);
-                // Marca como 'ehAmigoDireto' para não sugerir novamente se for amigo de outro amigo.
-                ehAmigoDireto[idAmigoNivel2] = true;
+            if (usuarioAtivo(rede, idAmigoNivel2) && !usuarioVisitado(area, idAmigoNivel2)) {
+                sugestoes[sugestoesEncontradas] = idAmigoNivel2;
+                intermediarios[sugestoesEncontradas] = idAmigoNivel1;
+                // Marca o sugerido para não sugeri-lo novamente se for amigo de outro amigo.
+                marcarVisitado(area, idAmigoNivel2);
                 sugestoesEncontradas++;
+                CONTAR_ESTATISTICA(estatisticas, arestasRelaxadas, 1);
+                contarFronteira(estatisticas, 2);
             }
             amigoDoAmigo = amigoDoAmigo->proximo;
         }
         amigoAtual = amigoAtual->proximo;
     }
+    CONTAR_ESTATISTICA(estatisticas, bytesAlocados, (long)((size_t)area->numTocados * sizeof(uint32_t)));
+    encerrarFase(estatisticas, FASE_BUSCA, &marca);
+    return sugestoesEncontradas;
+}
+
+// Função para sugerir amigos a um usuário.
+// Sugere amigos de amigos que ainda não são amigos diretos do usuário.
+void sugerirAmigos(RedeSocial* rede, int idUsuario) {
+    // Verifica se o ID do usuário é válido e se ele está ativo.
+    if (idUsuario < 0 || idUsuario >= MAX_USUARIOS || !usuarioAtivo(rede, idUsuario)) {
+        printf("Erro: ID de usuário inválido para sugestão de amigos.\n");
+        return;
+    }
+
+    printf("\n--- Sugestões de Amigos para %s (ID: %d) ---\n", nomeUsuario(rede, idUsuario), idUsuario);
+
+    // Calcula as sugestões e o amigo em comum pelo qual cada uma foi encontrada.
+    int sugestoes[MAX_USUARIOS];
+    int intermediarios[MAX_USUARIOS];
+    // Com "--estatisticas", coleta os contadores da consulta, mostra-os e soma-os ao agregado do menu.
+    EstatisticasConsulta estatisticas;
+    int sugestoesEncontradas = calcularSugestoes(rede, idUsuario, sugestoes, intermediarios, NULL,
+                                                 estatisticasAtivas ? &estatisticas : NULL);
+
+    for (int i = 0; i < sugestoesEncontradas; i++) {
+        printf("  - %s (ID: %d) (amigo de %s)\n",
+               nomeUsuario(rede, sugestoes[i]), sugestoes[i],
+               nomeUsuario(rede, intermediarios[i]));
+    }
     // Se nenhuma sugestão for encontrada.
     if (sugestoesEncontradas == 0) {
         printf("  Nenhuma sugestão de amigo encontrada no momento.\n");
     }
+    if (estatisticasAtivas) {
+        imprimirEstatisticas(&estatisticas);
+        acumularEstatisticas(&agregadosMenu[ESTATISTICAS_SUGERIR_AMIGOS], &estatisticas);
+    }
 }
 
-// Verifica a conectividade entre dois usuários usando uma implementação iterativa de DFS (com pilha).
-// Retorna true se existe um caminho entre o usuário de origem e o de destino, false caso contrário.
-bool verificarConectividade(RedeSocial* rede, int idUsuarioOrigem, int idUsuarioDestino) {
-    // Valida os IDs dos usuários e se estão ativos.
-    if (idUsuarioOrigem < 0 || idUsuarioOrigem >= MAX_USUARIOS || !rede->usuarios[idUsuarioOrigem].ativo ||
-        idUsuarioDestino < 0 || idUsuarioDestino >= MAX_USUARIOS || !rede->usuarios[idUsuarioDestino].ativo) {
-        printf("Erro: IDs de usuário inválidos para verificar conectividade.\n");
-        return false;
-    }
+// Função de comparação para ordenar candidatos por similaridade decrescente (e por ID, no empate).
+int compararCandidatosSimilares(const void* a, const void* b) {
+    const int* x = (const int*)a;
+    const int* y = (const int*)b;
+    if (x[1] != y[1]) return y[1] - x[1];
+    return x[0] - y[0];
+}
 
-    // Se origem e destino são o mesmo usuário, estão conectados.
-    if (idUsuarioOrigem == idUsuarioDestino) return true;
+// Busca os usuários mais parecidos com 'idUsuario' (maior similaridade de Jaccard estimada entre os
+// conjuntos de amigos) sem imprimir nada. Examina só os usuários que compartilham algum balde LSH com
+// ele, no máximo MAX_CANDIDATOS_LSH por balde, e estima a similaridade comparando as assinaturas.
+// O ID deve ser válido e ativo. Preenche 'similares' e 'coincidencias' (posições iguais das
+// assinaturas, de 0 a NUM_HASHES_MINHASH) em ordem decrescente de similaridade e retorna a quantidade
+// encontrada, limitada a 'maxResultados' (que deve ser no máximo MAX_RESULTADOS_SIMILARES).
+int buscarUsuariosSimilares(const RedeSocial* rede, int idUsuario, int maxResultados,
+                            int similares[], int coincidencias[]) {
+    const IndiceSimilaridade* indice = &rede->similaridade;
+    const uint32_t* assinatura = indice->assinatura[idUsuario];
+    if (assinatura[0] == UINT32_MAX) return 0; // Sem amigos: nada a comparar.
 
-    // Array para marcar usuários visitados.
-    bool visitado[MAX_USUARIOS] = {false};
-    // Pilha para a DFS iterativa.
-    int pilha[MAX_USUARIOS];
-    // Topo da pilha.
-    int topoPilha = -1;
+    // Candidatos em pares (ID, coincidências); um usuário pode aparecer em várias bandas.
+    int candidatos[NUM_BANDAS_LSH * MAX_CANDIDATOS_LSH][2];
+    int numCandidatos = 0;
+    for (int banda = 0; banda < NUM_BANDAS_LSH; banda++) {
+        uint32_t chave = indice->chaveBanda[banda][idUsuario];
+        int examinados = 0;
+        for (int v = indice->inicioBalde[banda][chave % NUM_BALDES_LSH];
+             v != -1 && examinados < MAX_CANDIDATOS_LSH; v = indice->proximoNoBalde[banda][v]) {
+            // Ignora o próprio usuário e colisões do balde com chaves diferentes.
+            if (v == idUsuario || indice->chaveBanda[banda][v] != chave || !usuarioAtivo(rede, v)) continue;
+            examinados++;
+            int iguais = 0;
+            for (int h = 0; h < NUM_HASHES_MINHASH; h++) iguais += indice->assinatura[v][h] == assinatura[h];
+            candidatos[numCandidatos][0] = v;
+            candidatos[numCandidatos][1] = iguais;
+            numCandidatos++;
+        }
+    }
 
-    // Empilha o usuário de origem e marca como visitado.
-    pilha[++topoPilha] = idUsuarioOrigem;
-    visitado[idUsuarioOrigem] = true;
+    // Ordena e descarta as repetições (que ficam adjacentes, pois têm o mesmo ID e a mesma estimativa).
+    qsort(candidatos, (size_t)numCandidatos, sizeof(candidatos[0]), compararCandidatosSimilares);
+    int total = 0;
+    for (int i = 0; i < numCandidatos && total < maxResultados; i++) {
+        if (i > 0 && candidatos[i][0] == candidatos[i - 1][0]) continue;
+        similares[total] = candidatos[i][0];
+        coincidencias[total] = candidatos[i][1];
+        total++;
+    }
+    return total;
+}
 
-    // Loop enquanto a pilha não estiver vazia.
-    while (topoPilha != -1) {
-        // Desempilha um usuário.
-        int u = pilha[topoPilha--];
+// Função que mostra os usuários mais parecidos com um usuário, segundo o índice MinHash/LSH.
+// A similaridade exibida é a estimativa da similaridade de Jaccard entre os conjuntos de amigos.
+void usuariosSimilares(RedeSocial* rede, int idUsuario) {
+    // Verifica se o ID do usuário é válido e se ele está ativo.
+    if (idUsuario < 0 || idUsuario >= MAX_USUARIOS || !usuarioAtivo(rede, idUsuario)) {
+        printf("Erro: ID de usuário inválido para busca de usuários similares.\n");
+        return;
+    }
 
-        // Se o usuário desempilhado é o destino, eles estão conectados.
+    printf("\n--- Usuários Similares a %s (ID: %d) ---\n", nomeUsuario(rede, idUsuario), idUsuario);
+    int similares[MAX_RESULTADOS_SIMILARES], coincidencias[MAX_RESULTADOS_SIMILARES];
+    int total = buscarUsuariosSimilares(rede, idUsuario, MAX_RESULTADOS_SIMILARES, similares, coincidencias);
+    for (int i = 0; i < total; i++) {
+        // Indica quem já é amigo direto (a lista do usuário é percorrida só para os resultados).
+        bool jaEhAmigo = false;
+        for (NoAmigo* amigo = rede->listaAmigos[idUsuario]; amigo != NULL && !jaEhAmigo; amigo = amigo->proximo) {
+            jaEhAmigo = amigo->idUsuario == similares[i];
+        }
+        printf("  - %s (ID: %d) - similaridade estimada %.0f%%%s\n",
+               nomeUsuario(rede, similares[i]), similares[i],
+               100.0 * coincidencias[i] / NUM_HASHES_MINHASH, jaEhAmigo ? " (já é amigo)" : "");
+    }
+    if (total == 0) {
+        printf("  Nenhum usuário similar encontrado.\n");
+    }
+}
+
+// Define o oráculo de distâncias por marcos ("landmarks"): os níveis de BFS de cada usuário em relação
+// a NUM_MARCOS usuários de maior grau, guardados em 1 byte cada. Pela desigualdade triangular,
+// d(a, b) <= d(a, m) + d(m, b) e d(a, b) >= |d(a, m) - d(m, b)| para todo marco m, então uma consulta
+// só lê 2 * NUM_MARCOS bytes contíguos. Níveis acima de 254 (e usuários não alcançados) ficam como
+// NIVEL_DESCONHECIDO. Como amizades nunca são removidas, um oráculo desatualizado ainda dá limites
+// superiores válidos (as distâncias só diminuem), mas não limites inferiores.
+typedef struct OraculoDistancias {
+    int numMarcos;                // Marcos efetivamente escolhidos (<= NUM_MARCOS).
+    int marcos[NUM_MARCOS];       // IDs dos usuários usados como marcos.
+    uint8_t* niveis;              // niveis[u * numMarcos + m]: distância do usuário u ao marco m.
+    unsigned long versao;         // Versão da rede usada na construção.
+} OraculoDistancias;
+
+// Define o trabalho compartilhado pelas threads que constroem o oráculo: cada thread pega o próximo
+// marco pelo contador atômico e grava os níveis da sua BFS (cada marco é uma coluna diferente).
+typedef struct ConstrucaoOraculo {
+    const RedeSocial* rede;
+    OraculoDistancias* oraculo;
+    atomic_int proximoMarco;
+} ConstrucaoOraculo;
+
+// Função executada pelas threads de construção do oráculo.
+void* executarConstrucaoOraculo(void* argumento) {
+    ConstrucaoOraculo* construcao = (ConstrucaoOraculo*)argumento;
+    OraculoDistancias* oraculo = construcao->oraculo;
+    AreaTrabalho* area = areaTrabalhoDaThread();
+    int m;
+    while ((m = atomic_fetch_add(&construcao->proximoMarco, 1)) < oraculo->numMarcos) {
+        int alcancados = BFSNiveis(construcao->rede, oraculo->marcos[m], area, NULL);
+        for (int i = 0; i < alcancados; i++) {
+            int u = area->fila[i];
+            if (area->distancia[u] < NIVEL_DESCONHECIDO) {
+                oraculo->niveis[(size_t)u * (size_t)oraculo->numMarcos + (size_t)m] = (uint8_t)area->distancia[u];
+            }
+        }
+    }
+    return NULL;
+}
+
+// Constrói o oráculo de distâncias da rede sem imprimir nada: escolhe como marcos os NUM_MARCOS usuários
+// de maior grau e executa as BFS dos marcos em paralelo, com até 'numThreads' threads.
+// Retorna o oráculo novo (que pertence ao chamador) ou NULL se nenhum usuário tiver amigos.
+OraculoDistancias* construirOraculoDistancias(const RedeSocial* rede, int numThreads) {
+    OraculoDistancias* oraculo = (OraculoDistancias*)malloc(sizeof(OraculoDistancias));
+    if (!oraculo) {
+        perror("Erro ao alocar memória para o oráculo de distâncias");
+        exit(EXIT_FAILURE);
+    }
+
+    // Seleciona os marcos: mantém os NUM_MARCOS maiores graus em ordem decrescente (inserção ordenada).
+    int grausMarcos[NUM_MARCOS];
+    oraculo->numMarcos = 0;
+    for (int u = 0; u < MAX_USUARIOS; u++) {
+        if (!usuarioAtivo(rede, u)) continue;
+        int grau = 0;
+        for (NoAmigo* amigo = rede->listaAmigos[u]; amigo != NULL; amigo = amigo->proximo) grau++;
+        if (grau == 0) continue;
+        if (oraculo->numMarcos == NUM_MARCOS && grau <= grausMarcos[NUM_MARCOS - 1]) continue;
+        int i = oraculo->numMarcos < NUM_MARCOS ? oraculo->numMarcos++ : NUM_MARCOS - 1;
+        while (i > 0 && grausMarcos[i - 1] < grau) {
+            grausMarcos[i] = grausMarcos[i - 1];
+            oraculo->marcos[i] = oraculo->marcos[i - 1];
+            i--;
+        }
+        grausMarcos[i] = grau;
+        oraculo->marcos[i] = u;
+    }
+    if (oraculo->numMarcos == 0) {
+        free(oraculo);
+        return NULL;
+    }
+
+    size_t tamanho = (size_t)MAX_USUARIOS * (size_t)oraculo->numMarcos;
+    oraculo->niveis = (uint8_t*)malloc(tamanho);
+    if (!oraculo->niveis) {
+        perror("Erro ao alocar memória para o oráculo de distâncias");
+        exit(EXIT_FAILURE);
+    }
+    memset(oraculo->niveis, NIVEL_DESCONHECIDO, tamanho);
+    oraculo->versao = rede->versao;
+
+    // Uma BFS por marco, distribuídas entre as threads.
+    ConstrucaoOraculo construcao;
+    construcao.rede = rede;
+    construcao.oraculo = oraculo;
+    atomic_init(&construcao.proximoMarco, 0);
+    if (numThreads > oraculo->numMarcos) numThreads = oraculo->numMarcos;
+    if (numThreads < 1) numThreads = 1;
+    pthread_t threads[NUM_MARCOS];
+    for (int i = 1; i < numThreads; i++) pthread_create(&threads[i], NULL, executarConstrucaoOraculo, &construcao);
+    executarConstrucaoOraculo(&construcao); // A thread chamadora também trabalha.
+    for (int i = 1; i < numThreads; i++) pthread_join(threads[i], NULL);
+    return oraculo;
+}
+
+// Função que libera um oráculo de distâncias.
+void liberarOraculoDistancias(OraculoDistancias* oraculo) {
+    if (oraculo == NULL) return;
+    free(oraculo->niveis);
+    free(oraculo);
+}
+
+// Consulta o oráculo: retorna o menor limite superior d(a, m) + d(m, b) entre os marcos, ou -1 se
+// nenhum marco alcança os dois usuários. Se 'limiteInferior' não for NULL, recebe o maior
+// |d(a, m) - d(m, b)| (só é válido se o oráculo estiver na versão atual da rede).
+static inline int consultarOraculo(const OraculoDistancias* oraculo, int a, int b, int* limiteInferior) {
+    if (a == b) { // Distância zero, mesmo para usuários fora do alcance dos marcos.
+        if (limiteInferior != NULL) *limiteInferior = 0;
+        return 0;
+    }
+    const uint8_t* niveisA = &oraculo->niveis[(size_t)a * (size_t)oraculo->numMarcos];
+    const uint8_t* niveisB = &oraculo->niveis[(size_t)b * (size_t)oraculo->numMarcos];
+    int superior = INT_MAX, inferior = 0;
+    for (int m = 0; m < oraculo->numMarcos; m++) {
+        int da = niveisA[m], db = niveisB[m];
+        if (da == NIVEL_DESCONHECIDO || db == NIVEL_DESCONHECIDO) continue;
+        if (da + db < superior) superior = da + db;
+        int diferenca = da > db ? da - db : db - da;
+        if (diferenca > inferior) inferior = diferenca;
+    }
+    if (limiteInferior != NULL) *limiteInferior = inferior;
+    return superior == INT_MAX ? -1 : superior;
+}
+
+// Calcula a distância exata (em saltos) entre dois usuários com uma BFS a partir de 'a' que para ao
+// encontrar 'b' ou ao passar de 'limite' níveis (limite negativo: sem limite), usando 'area' (NULL: a
+// área da thread chamadora). Retorna a distância, ou -1 se 'b' não foi alcançado.
+int distanciaExata(const RedeSocial* rede, int a, int b, int limite, AreaTrabalho* area) {
+    if (a == b) return 0;
+    if (area == NULL) area = areaTrabalhoDaThread();
+    int* fila = area->fila;
+    int* distancia = area->distancia;
+    reiniciarAreaTrabalho(area);
+    int inicioFila = 0, fimFila = 0;
+    fila[fimFila++] = a;
+    marcarVisitado(area, a);
+    distancia[a] = 0;
+    while (inicioFila < fimFila) {
+        int u = fila[inicioFila++];
+        if (limite >= 0 && distancia[u] >= limite) break; // Vizinhos de 'u' estariam além do limite.
+        for (NoAmigo* amigo = rede->listaAmigos[u]; amigo != NULL; amigo = amigo->proximo) {
+            int v = amigo->idUsuario;
+            if (!usuarioAtivo(rede, v) || usuarioVisitado(area, v)) continue;
+            marcarVisitado(area, v);
+            distancia[v] = distancia[u] + 1;
+            if (v == b) return distancia[v];
+            fila[fimFila++] = v;
+        }
+    }
+    return -1;
+}
+
+// Função que mostra a distância (graus de separação) entre dois usuários usando o oráculo de marcos.
+// Reconstrói o oráculo em paralelo se ele não existir ou estiver desatualizado e, quando os limites
+// não coincidem, refina a resposta com uma BFS limitada pelo limite superior.
+void distanciaEntreUsuarios(RedeSocial* rede, int idUsuario1, int idUsuario2) {
+    // Verifica se os IDs dos usuários são válidos e se estão ativos.
+    if (idUsuario1 < 0 || idUsuario1 >= MAX_USUARIOS || !usuarioAtivo(rede, idUsuario1) ||
+        idUsuario2 < 0 || idUsuario2 >= MAX_USUARIOS || !usuarioAtivo(rede, idUsuario2)) {
+        printf("Erro: IDs de usuário inválidos para calcular a distância.\n");
+        return;
+    }
+
+    if (rede->oraculo == NULL || rede->oraculo->versao != rede->versao) {
+        double inicio = agoraMicrossegundos();
+        liberarOraculoDistancias(rede->oraculo);
+        rede->oraculo = construirOraculoDistancias(rede, NUM_THREADS_ORACULO);
+        if (rede->oraculo != NULL) {
+            printf("Oráculo de distâncias construído com %d marcos em %.2f ms.\n",
+                   rede->oraculo->numMarcos, (agoraMicrossegundos() - inicio) / 1e3);
+        }
+    }
+
+    printf("\n--- Distância entre %s (ID: %d) e %s (ID: %d) ---\n",
+           nomeUsuario(rede, idUsuario1), idUsuario1, nomeUsuario(rede, idUsuario2), idUsuario2);
+    int superior = -1, inferior = 0;
+    if (rede->oraculo != NULL) superior = consultarOraculo(rede->oraculo, idUsuario1, idUsuario2, &inferior);
+    if (superior >= 0) {
+        printf("  Estimativa pelos marcos: entre %d e %d saltos.\n", inferior, superior);
+    } else {
+        printf("  Nenhum marco alcança os dois usuários.\n");
+    }
+
+    // Refinamento exato (desnecessário quando os limites coincidem).
+    int exata = superior >= 0 && inferior == superior ? superior : -1;
+    if (exata < 0) {
+        exata = distanciaExata(rede, idUsuario1, idUsuario2, superior, NULL);
+    }
+    if (exata >= 0) {
+        printf("  Distância exata: %d saltos.\n", exata);
+    } else {
+        printf("  Os usuários NÃO ESTÃO conectados.\n");
+    }
+}
+
+// Define o resultado da estimativa da função de vizinhança (HyperANF).
+// 'funcao[t]' estima a função de vizinhança N(t): o número de pares (u, v) com v a no máximo t saltos de u
+// (cada usuário conta a si mesmo). 'alcance[u * (passos + 1) + t]' estima quantos usuários estão a no
+// máximo t saltos de u. A partir do passo em que nenhum contador muda, os valores se repetem.
+typedef struct AnaliseVizinhanca {
+    int passos;                               // Maior número de saltos calculado.
+    int passoEstavel;                         // Passo a partir do qual nada muda (-1 se ainda mudava em 'passos').
+    double funcao[MAX_PASSOS_HYPERANF + 1];   // Função de vizinhança estimada, de 0 a 'passos' saltos.
+    float* alcance;                           // Alcance estimado de cada usuário para cada número de saltos.
+} AnaliseVizinhanca;
+
+// Define o estado compartilhado por um passo do HyperANF: cada thread pega blocos de usuários pelo
+// contador atômico, une os contadores dos amigos e acumula a sua parte da função de vizinhança.
+typedef struct PassoHyperANF {
+    const RedeSocial* rede;
+    const uint8_t* atuais;                    // Contadores do passo anterior (somente leitura).
+    uint8_t* proximos;                        // Contadores deste passo (cada usuário escrito por uma thread).
+    AnaliseVizinhanca* analise;
+    int passo;
+    atomic_int proximoBloco;
+    atomic_bool mudou;                        // Algum contador mudou neste passo.
+    double somas[NUM_THREADS_HYPERANF];       // Parte de N(passo) somada por cada thread.
+} PassoHyperANF;
+
+// Define os argumentos de cada thread de um passo do HyperANF.
+typedef struct ArgumentoHyperANF {
+    PassoHyperANF* passo;
+    int indice;
+} ArgumentoHyperANF;
+
+// Retorna o hash de 64 bits de um ID de usuário (finalizador do splitmix64), usado para inserir o
+// usuário no seu contador HyperLogLog.
+static inline uint64_t hashUsuarioHLL(int idUsuario) {
+    uint64_t z = (uint64_t)(uint32_t)idUsuario + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Retorna o logaritmo natural de x >= 1 sem depender da libm: reduz x ao intervalo [1, 2) dividindo
+// por 2 e usa a série ln(x) = 2 * (y + y^3/3 + y^5/5 + ...), com y = (x - 1) / (x + 1).
+double logaritmoNatural(double x) {
+    const double LN2 = 0.69314718055994530942;
+    int expoente = 0;
+    while (x >= 2.0) {
+        x /= 2.0;
+        expoente++;
+    }
+    double y = (x - 1.0) / (x + 1.0), y2 = y * y, termo = y, soma = 0.0;
+    for (int k = 1; k < 40; k += 2) {
+        soma += termo / (double)k;
+        termo *= y2;
+    }
+    return 2.0 * soma + (double)expoente * LN2;
+}
+
+// Estima a cardinalidade do conjunto representado por um contador HyperLogLog (média harmônica dos
+// registradores, com a correção de contagem linear para conjuntos pequenos).
+double estimarCardinalidadeHLL(const uint8_t* registradores) {
+    const double m = REGISTRADORES_HLL;
+    double soma = 0.0;
+    int zeros = 0;
+    for (int j = 0; j < REGISTRADORES_HLL; j++) {
+        soma += 1.0 / (double)(1ULL << registradores[j]); // 2^-registrador (registradores < 64).
+        zeros += registradores[j] == 0;
+    }
+    double estimativa = 0.7213 / (1.0 + 1.079 / m) * m * m / soma;
+    if (estimativa <= 2.5 * m && zeros > 0) estimativa = m * logaritmoNatural(m / (double)zeros);
+    return estimativa;
+}
+
+// Une o contador 'origem' ao contador 'destino' (máximo registrador a registrador).
+// Retorna true se algum registrador de 'destino' mudou.
+static inline bool unirContadoresHLL(uint8_t* destino, const uint8_t* origem) {
+#if defined(__AVX2__)
+    // 32 registradores por instrução.
+    __m256i diferencas = _mm256_setzero_si256();
+    for (int j = 0; j < REGISTRADORES_HLL; j += 32) {
+        __m256i atual = _mm256_load_si256((const __m256i*)(destino + j));
+        __m256i unido = _mm256_max_epu8(atual, _mm256_load_si256((const __m256i*)(origem + j)));
+        diferencas = _mm256_or_si256(diferencas, _mm256_xor_si256(atual, unido));
+        _mm256_store_si256((__m256i*)(destino + j), unido);
+    }
+    return !_mm256_testz_si256(diferencas, diferencas);
+#elif defined(__SSE2__)
+    // 16 registradores por instrução (SSE2 está presente em todo processador x86-64).
+    __m128i diferencas = _mm_setzero_si128();
+    for (int j = 0; j < REGISTRADORES_HLL; j += 16) {
+        __m128i atual = _mm_load_si128((const __m128i*)(destino + j));
+        __m128i unido = _mm_max_epu8(atual, _mm_load_si128((const __m128i*)(origem + j)));
+        diferencas = _mm_or_si128(diferencas, _mm_xor_si128(atual, unido));
+        _mm_store_si128((__m128i*)(destino + j), unido);
+    }
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(diferencas, _mm_setzero_si128())) != 0xFFFF;
+#else
+    bool mudou = false;
+    for (int j = 0; j < REGISTRADORES_HLL; j++) {
+        if (origem[j] > destino[j]) {
+            destino[j] = origem[j];
+            mudou = true;
+        }
+    }
+    return mudou;
+#endif
+}
+
+// Função executada pelas threads de um passo do HyperANF: para cada usuário do bloco, o novo contador
+// é a união do seu contador com os dos amigos (a bola de raio t é a união das bolas de raio t - 1).
+void* executarPassoHyperANF(void* argumento) {
+    ArgumentoHyperANF* arg = (ArgumentoHyperANF*)argumento;
+    PassoHyperANF* passo = arg->passo;
+    AnaliseVizinhanca* analise = passo->analise;
+    double soma = 0.0;
+    bool mudou = false;
+    int inicio;
+    while ((inicio = atomic_fetch_add(&passo->proximoBloco, BLOCO_USUARIOS_HYPERANF)) < MAX_USUARIOS) {
+        int fim = inicio + BLOCO_USUARIOS_HYPERANF < MAX_USUARIOS ? inicio + BLOCO_USUARIOS_HYPERANF : MAX_USUARIOS;
+        for (int u = inicio; u < fim; u++) {
+            if (!usuarioAtivo(passo->rede, u)) continue;
+            uint8_t* contador = &passo->proximos[(size_t)u * REGISTRADORES_HLL];
+            memcpy(contador, &passo->atuais[(size_t)u * REGISTRADORES_HLL], REGISTRADORES_HLL);
+            for (NoAmigo* amigo = passo->rede->listaAmigos[u]; amigo != NULL; amigo = amigo->proximo) {
+                if (!usuarioAtivo(passo->rede, amigo->idUsuario)) continue;
+                mudou |= unirContadoresHLL(contador, &passo->atuais[(size_t)amigo->idUsuario * REGISTRADORES_HLL]);
+            }
+            double estimativa = estimarCardinalidadeHLL(contador);
+            analise->alcance[(size_t)u * (size_t)(analise->passos + 1) + (size_t)passo->passo] = (float)estimativa;
+            soma += estimativa;
+        }
+    }
+    passo->somas[arg->indice] = soma;
+    if (mudou) atomic_store(&passo->mudou, true);
+    return NULL;
+}
+
+// Estima a função de vizinhança da rede e o alcance de cada usuário em até 'maxPassos' saltos
+// (no máximo MAX_PASSOS_HYPERANF) sem imprimir nada, no estilo HyperANF: cada usuário tem um contador
+// HyperLogLog que começa só com ele mesmo, e cada passo une os contadores ao longo das amizades.
+// São 'maxPassos' passadas sobre as listas de amigos (menos, se os contadores convergirem), cada uma
+// dividida entre NUM_THREADS_HYPERANF threads. O array 'alcance' do resultado pertence ao chamador.
+AnaliseVizinhanca* calcularFuncaoVizinhanca(const RedeSocial* rede, int maxPassos) {
+    if (maxPassos > MAX_PASSOS_HYPERANF) maxPassos = MAX_PASSOS_HYPERANF;
+    if (maxPassos < 0) maxPassos = 0;
+    AnaliseVizinhanca* analise = (AnaliseVizinhanca*)malloc(sizeof(AnaliseVizinhanca));
+    size_t tamanhoContadores = (size_t)MAX_USUARIOS * REGISTRADORES_HLL; // Múltiplo de 64 (aligned_alloc).
+    uint8_t* atuais = (uint8_t*)aligned_alloc(64, tamanhoContadores);
+    uint8_t* proximos = (uint8_t*)aligned_alloc(64, tamanhoContadores);
+    if (!analise || !atuais || !proximos) {
+        perror("Erro ao alocar memória para o HyperANF");
+        exit(EXIT_FAILURE);
+    }
+    analise->passos = maxPassos;
+    analise->passoEstavel = -1;
+    analise->alcance = (float*)calloc((size_t)MAX_USUARIOS * (size_t)(maxPassos + 1), sizeof(float));
+    if (!analise->alcance) {
+        perror("Erro ao alocar memória para o HyperANF");
+        exit(EXIT_FAILURE);
+    }
+
+    // Passo 0: cada contador contém só o próprio usuário. O hash do ID escolhe o registrador (bits altos)
+    // e o valor é a posição do primeiro bit 1 nos bits restantes.
+    memset(atuais, 0, tamanhoContadores);
+    analise->funcao[0] = 0.0;
+    for (int u = 0; u < MAX_USUARIOS; u++) {
+        if (!usuarioAtivo(rede, u)) continue;
+        uint64_t hash = hashUsuarioHLL(u);
+        int registrador = (int)(hash >> (64 - BITS_HLL));
+        uint64_t restantes = hash << BITS_HLL;
+        int posicao = 1;
+        while (posicao <= 64 - BITS_HLL && (restantes & (1ULL << 63)) == 0) {
+            restantes <<= 1;
+            posicao++;
+        }
+        atuais[(size_t)u * REGISTRADORES_HLL + (size_t)registrador] = (uint8_t)posicao;
+        double estimativa = estimarCardinalidadeHLL(&atuais[(size_t)u * REGISTRADORES_HLL]);
+        analise->alcance[(size_t)u * (size_t)(maxPassos + 1)] = (float)estimativa;
+        analise->funcao[0] += estimativa;
+    }
+
+    // Passos 1..maxPassos, cada um com as threads sincronizadas ao final (os contadores do passo t só
+    // dependem dos do passo t - 1).
+    PassoHyperANF passo;
+    passo.rede = rede;
+    passo.analise = analise;
+    ArgumentoHyperANF argumentos[NUM_THREADS_HYPERANF];
+    pthread_t threads[NUM_THREADS_HYPERANF];
+    int t = 1;
+    for (; t <= maxPassos; t++) {
+        passo.atuais = atuais;
+        passo.proximos = proximos;
+        passo.passo = t;
+        atomic_init(&passo.proximoBloco, 0);
+        atomic_init(&passo.mudou, false);
+        for (int i = 0; i < NUM_THREADS_HYPERANF; i++) {
+            argumentos[i].passo = &passo;
+            argumentos[i].indice = i;
+            if (i > 0) pthread_create(&threads[i], NULL, executarPassoHyperANF, &argumentos[i]);
+        }
+        executarPassoHyperANF(&argumentos[0]); // A thread chamadora também trabalha.
+        for (int i = 1; i < NUM_THREADS_HYPERANF; i++) pthread_join(threads[i], NULL);
+        analise->funcao[t] = 0.0;
+        for (int i = 0; i < NUM_THREADS_HYPERANF; i++) analise->funcao[t] += passo.somas[i];
+        // Troca os papéis dos arrays para o próximo passo.
+        uint8_t* temporario = atuais;
+        atuais = proximos;
+        proximos = temporario;
+        if (!atomic_load(&passo.mudou)) break; // Convergiu: os passos seguintes seriam iguais.
+    }
+    // Completa os passos não executados repetindo os valores do último.
+    if (t <= maxPassos) {
+        analise->passoEstavel = t - 1;
+        for (int s = t + 1; s <= maxPassos; s++) {
+            analise->funcao[s] = analise->funcao[t];
+            for (int u = 0; u < MAX_USUARIOS; u++) {
+                size_t linha = (size_t)u * (size_t)(maxPassos + 1);
+                analise->alcance[linha + (size_t)s] = analise->alcance[linha + (size_t)t];
+            }
+        }
+    }
+    free(atuais);
+    free(proximos);
+    return analise;
+}
+
+// Função que libera o resultado do HyperANF.
+void liberarAnaliseVizinhanca(AnaliseVizinhanca* analise) {
+    if (analise == NULL) return;
+    free(analise->alcance);
+    free(analise);
+}
+
+// Função que estima e mostra a função de vizinhança da rede até 'maxPassos' saltos e, se 'idUsuario'
+// for um usuário ativo, o alcance estimado dele a cada número de saltos ao lado do valor exato (BFS).
+void analisarVizinhanca(RedeSocial* rede, int maxPassos, int idUsuario) {
+    if (maxPassos < 1 || maxPassos > MAX_PASSOS_HYPERANF) {
+        printf("Erro: o número de saltos deve estar entre 1 e %d.\n", MAX_PASSOS_HYPERANF);
+        return;
+    }
+    bool mostrarUsuario = idUsuario >= 0 && idUsuario < MAX_USUARIOS && usuarioAtivo(rede, idUsuario);
+
+    double inicio = agoraMicrossegundos();
+    AnaliseVizinhanca* analise = calcularFuncaoVizinhanca(rede, maxPassos);
+    printf("\n--- Função de Vizinhança (HyperANF, %d registradores por usuário) ---\n", REGISTRADORES_HLL);
+    printf("Calculada em %.2f ms", (agoraMicrossegundos() - inicio) / 1e3);
+    if (analise->passoEstavel >= 0) {
+        printf("; nenhum alcance muda a partir de %d saltos.\n", analise->passoEstavel);
+    } else {
+        printf(".\n");
+    }
+
+    // Alcance exato do usuário escolhido, acumulado por nível, para comparação.
+    int alcanceExato[MAX_PASSOS_HYPERANF + 1] = {0};
+    if (mostrarUsuario) {
+        AreaTrabalho* area = areaTrabalhoDaThread();
+        int alcancados = BFSNiveis(rede, idUsuario, area, NULL);
+        for (int i = 0; i < alcancados; i++) {
+            for (int t = area->distancia[area->fila[i]]; t <= maxPassos; t++) alcanceExato[t]++;
+        }
+        printf("Saltos | pares alcançáveis | alcance médio | alcance de %s (ID: %d): estimado / exato\n",
+               nomeUsuario(rede, idUsuario), idUsuario);
+    } else {
+        printf("Saltos | pares alcançáveis | alcance médio\n");
+    }
+    for (int t = 0; t <= maxPassos; t++) {
+        printf("%6d | %17.0f | %13.2f", t, analise->funcao[t],
+               rede->numUsuariosAtivos > 0 ? analise->funcao[t] / (double)rede->numUsuariosAtivos : 0.0);
+        if (mostrarUsuario) {
+            printf(" | %.1f / %d", analise->alcance[(size_t)idUsuario * (size_t)(maxPassos + 1) + (size_t)t], alcanceExato[t]);
+        }
+        printf("\n");
+    }
+    liberarAnaliseVizinhanca(analise);
+}
+
+// Define o resultado da contagem de triângulos (trios de usuários amigos entre si).
+typedef struct AnaliseTriangulos {
+    long total;                    // Triângulos da rede (cada um contado uma vez).
+    atomic_long* triangulos;       // Triângulos de que cada usuário participa (incrementados pelas threads).
+    double* coeficientes;          // Coeficiente de agrupamento local de cada usuário (0 com menos de 2 amigos).
+    double coeficienteMedio;       // Média dos coeficientes locais dos usuários ativos.
+    double transitividade;         // Coeficiente global: 3 * triângulos / caminhos de 2 arestas.
+} AnaliseTriangulos;
+
+// Define a orientação da rede usada na contagem: cada amizade vira uma única aresta do usuário de menor
+// grau para o de maior grau (desempate pelo ID), guardada em formato CSR com os destinos ordenados por ID.
+// Cada usuário fica com no máximo O(sqrt(amizades)) arestas de saída, inclusive os hubs.
+typedef struct OrientacaoTriangulos {
+    size_t* inicio;                // Arestas de saída de u: destinos[inicio[u]] até destinos[inicio[u + 1] - 1].
+    int* destinos;
+} OrientacaoTriangulos;
+
+// Define o trabalho compartilhado pelas threads da contagem: cada thread pega o próximo bloco de usuários
+// pelo contador atômico, de modo que as threads que terminam antes continuam pegando trabalho.
+typedef struct ContagemTriangulos {
+    const OrientacaoTriangulos* orientacao;
+    AnaliseTriangulos* analise;
+    atomic_int proximoBloco;
+    atomic_long total;
+} ContagemTriangulos;
+
+// Função de comparação de inteiros (IDs de usuários) para qsort.
+int compararInteiros(const void* a, const void* b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+// Retorna a posição do primeiro elemento >= 'valor' em lista[inicio..tamanho), procurando por galope
+// (saltos dobrando de tamanho) e depois por busca binária no último intervalo.
+static inline int galopar(const int* lista, int inicio, int tamanho, int valor) {
+    int passo = 1, fim = inicio;
+    while (fim < tamanho && lista[fim] < valor) {
+        inicio = fim + 1;
+        fim += passo;
+        passo *= 2;
+    }
+    if (fim > tamanho) fim = tamanho;
+    while (inicio < fim) {
+        int meio = inicio + (fim - inicio) / 2;
+        if (lista[meio] < valor) inicio = meio + 1;
+        else fim = meio;
+    }
+    return inicio;
+}
+
+// Conta os IDs comuns a duas listas ordenadas (os terceiros vértices dos triângulos da aresta) e soma um
+// triângulo a cada um deles. Listas de tamanhos parecidos são intercaladas; quando uma é muito maior que
+// a outra (aresta de um hub), cada ID da menor é procurado por galope na maior.
+static long intersectarListas(const int* a, int tamanhoA, const int* b, int tamanhoB, atomic_long* triangulos) {
+    if (tamanhoA > tamanhoB) {
+        const int* temporario = a;
+        a = b;
+        b = temporario;
+        int tamanho = tamanhoA;
+        tamanhoA = tamanhoB;
+        tamanhoB = tamanho;
+    }
+    long comuns = 0;
+    int i = 0, j = 0;
+    if (tamanhoB > 32 * tamanhoA) {
+        for (; i < tamanhoA && j < tamanhoB; i++) {
+            j = galopar(b, j, tamanhoB, a[i]);
+            if (j < tamanhoB && b[j] == a[i]) {
+                atomic_fetch_add_explicit(&triangulos[a[i]], 1, memory_order_relaxed);
+                comuns++;
+                j++;
+            }
+        }
+        return comuns;
+    }
+    while (i < tamanhoA && j < tamanhoB) {
+        if (a[i] < b[j]) {
+            i++;
+        } else if (a[i] > b[j]) {
+            j++;
+        } else {
+            atomic_fetch_add_explicit(&triangulos[a[i]], 1, memory_order_relaxed);
+            comuns++;
+            i++;
+            j++;
+        }
+    }
+    return comuns;
+}
+
+// Função executada pelas threads da contagem de triângulos. Cada triângulo é encontrado uma única vez,
+// a partir do seu vértice de menor posto u: para cada aresta u -> v, os terceiros vértices são os
+// destinos comuns de u e v.
+void* executarContagemTriangulos(void* argumento) {
+    ContagemTriangulos* contagem = (ContagemTriangulos*)argumento;
+    const OrientacaoTriangulos* orientacao = contagem->orientacao;
+    atomic_long* triangulos = contagem->analise->triangulos;
+    long total = 0;
+    int inicio;
+    while ((inicio = atomic_fetch_add(&contagem->proximoBloco, BLOCO_USUARIOS_TRIANGULOS)) < MAX_USUARIOS) {
+        int fim = inicio + BLOCO_USUARIOS_TRIANGULOS < MAX_USUARIOS ? inicio + BLOCO_USUARIOS_TRIANGULOS : MAX_USUARIOS;
+        for (int u = inicio; u < fim; u++) {
+            const int* saidaU = &orientacao->destinos[orientacao->inicio[u]];
+            int grauU = (int)(orientacao->inicio[u + 1] - orientacao->inicio[u]);
+            long doUsuario = 0;
+            for (int k = 0; k < grauU; k++) {
+                int v = saidaU[k];
+                const int* saidaV = &orientacao->destinos[orientacao->inicio[v]];
+                int grauV = (int)(orientacao->inicio[v + 1] - orientacao->inicio[v]);
+                long comuns = intersectarListas(saidaU, grauU, saidaV, grauV, triangulos);
+                if (comuns > 0) atomic_fetch_add_explicit(&triangulos[v], comuns, memory_order_relaxed);
+                doUsuario += comuns;
+            }
+            if (doUsuario > 0) atomic_fetch_add_explicit(&triangulos[u], doUsuario, memory_order_relaxed);
+            total += doUsuario;
+        }
+    }
+    atomic_fetch_add(&contagem->total, total);
+    return NULL;
+}
+
+// Conta os triângulos da rede (por usuário e no total) e calcula os coeficientes de agrupamento sem
+// imprimir nada, com NUM_THREADS_TRIANGULOS threads. A única memória além do resultado é a orientação
+// CSR da rede (metade das amizades), já que as listas encadeadas de amigos não estão ordenadas.
+// O resultado pertence ao chamador.
+AnaliseTriangulos* contarTriangulos(const RedeSocial* rede) {
+    AnaliseTriangulos* analise = (AnaliseTriangulos*)malloc(sizeof(AnaliseTriangulos));
+    OrientacaoTriangulos orientacao;
+    orientacao.inicio = (size_t*)calloc((size_t)MAX_USUARIOS + 1, sizeof(size_t));
+    int* grau = (int*)calloc(MAX_USUARIOS, sizeof(int));
+    if (!analise || !orientacao.inicio || !grau) {
+        perror("Erro ao alocar memória para a contagem de triângulos");
+        exit(EXIT_FAILURE);
+    }
+    analise->triangulos = (atomic_long*)malloc(MAX_USUARIOS * sizeof(atomic_long));
+    analise->coeficientes = (double*)calloc(MAX_USUARIOS, sizeof(double));
+    if (!analise->triangulos || !analise->coeficientes) {
+        perror("Erro ao alocar memória para a contagem de triângulos");
+        exit(EXIT_FAILURE);
+    }
+    for (int u = 0; u < MAX_USUARIOS; u++) atomic_init(&analise->triangulos[u], 0);
+
+    // Graus (só amizades entre usuários ativos) e, em seguida, as arestas de saída de cada usuário.
+    for (int u = 0; u < MAX_USUARIOS; u++) {
+        if (!usuarioAtivo(rede, u)) continue;
+        for (NoAmigo* amigo = rede->listaAmigos[u]; amigo != NULL; amigo = amigo->proximo) {
+            if (usuarioAtivo(rede, amigo->idUsuario)) grau[u]++;
+        }
+    }
+    for (int u = 0; u < MAX_USUARIOS; u++) {
+        size_t saida = 0;
+        if (usuarioAtivo(rede, u)) {
+            for (NoAmigo* amigo = rede->listaAmigos[u]; amigo != NULL; amigo = amigo->proximo) {
+                int v = amigo->idUsuario;
+                if (usuarioAtivo(rede, v) && (grau[u] < grau[v] || (grau[u] == grau[v] && u < v))) saida++;
+            }
+        }
+        orientacao.inicio[u + 1] = orientacao.inicio[u] + saida;
+    }
+    orientacao.destinos = (int*)malloc((orientacao.inicio[MAX_USUARIOS] > 0 ? orientacao.inicio[MAX_USUARIOS] : 1) * sizeof(int));
+    if (!orientacao.destinos) {
+        perror("Erro ao alocar memória para a contagem de triângulos");
+        exit(EXIT_FAILURE);
+    }
+    for (int u = 0; u < MAX_USUARIOS; u++) {
+        if (!usuarioAtivo(rede, u)) continue;
+        size_t posicao = orientacao.inicio[u];
+        for (NoAmigo* amigo = rede->listaAmigos[u]; amigo != NULL; amigo = amigo->proximo) {
+            int v = amigo->idUsuario;
+            if (usuarioAtivo(rede, v) && (grau[u] < grau[v] || (grau[u] == grau[v] && u < v))) {
+                orientacao.destinos[posicao++] = v;
+            }
+        }
+        qsort(&orientacao.destinos[orientacao.inicio[u]], posicao - orientacao.inicio[u], sizeof(int), compararInteiros);
+    }
+
+    // Contagem paralela (a thread chamadora também conta).
+    ContagemTriangulos contagem;
+    contagem.orientacao = &orientacao;
+    contagem.analise = analise;
+    atomic_init(&contagem.proximoBloco, 0);
+    atomic_init(&contagem.total, 0);
+    pthread_t threads[NUM_THREADS_TRIANGULOS];
+    for (int i = 1; i < NUM_THREADS_TRIANGULOS; i++) pthread_create(&threads[i], NULL, executarContagemTriangulos, &contagem);
+    executarContagemTriangulos(&contagem);
+    for (int i = 1; i < NUM_THREADS_TRIANGULOS; i++) pthread_join(threads[i], NULL);
+    analise->total = atomic_load(&contagem.total);
+
+    // Coeficientes: local = triângulos / pares de amigos; global = 3 * triângulos / pares de amigos da rede.
+    double somaCoeficientes = 0.0, paresDeAmigos = 0.0;
+    for (int u = 0; u < MAX_USUARIOS; u++) {
+        if (grau[u] < 2) continue;
+        double pares = (double)grau[u] * (double)(grau[u] - 1) / 2.0;
+        analise->coeficientes[u] = (double)atomic_load(&analise->triangulos[u]) / pares;
+        somaCoeficientes += analise->coeficientes[u];
+        paresDeAmigos += pares;
+    }
+    analise->coeficienteMedio = rede->numUsuariosAtivos > 0 ? somaCoeficientes / (double)rede->numUsuariosAtivos : 0.0;
+    analise->transitividade = paresDeAmigos > 0 ? 3.0 * (double)analise->total / paresDeAmigos : 0.0;
+
+    free(orientacao.inicio);
+    free(orientacao.destinos);
+    free(grau);
+    return analise;
+}
+
+// Função que libera o resultado da contagem de triângulos.
+void liberarAnaliseTriangulos(AnaliseTriangulos* analise) {
+    if (analise == NULL) return;
+    free(analise->triangulos);
+    free(analise->coeficientes);
+    free(analise);
+}
+
+// Função que conta os triângulos da rede e mostra, para cada usuário ativo, os triângulos de que ele
+// participa e o seu coeficiente de agrupamento, seguidos dos totais da rede.
+void analisarTriangulos(RedeSocial* rede) {
+    double inicio = agoraMicrossegundos();
+    AnaliseTriangulos* analise = contarTriangulos(rede);
+    double tempo = agoraMicrossegundos() - inicio;
+
+    printf("\n--- Triângulos e Coeficientes de Agrupamento ---\n");
+    for (int u = 0; u < MAX_USUARIOS; u++) {
+        if (!usuarioAtivo(rede, u)) continue;
+        printf("ID: %d, Nome: %s - %ld triângulo(s), coeficiente de agrupamento %.3f\n", u, nomeUsuario(rede, u),
+               atomic_load(&analise->triangulos[u]), analise->coeficientes[u]);
+    }
+    printf("Total de triângulos: %ld\n", analise->total);
+    printf("Coeficiente de agrupamento médio: %.3f\n", analise->coeficienteMedio);
+    printf("Transitividade (coeficiente global): %.3f\n", analise->transitividade);
+    printf("Calculado em %.2f ms com %d threads.\n", tempo / 1e3, NUM_THREADS_TRIANGULOS);
+    liberarAnaliseTriangulos(analise);
+}
+
+// Define o consumidor dos resultados de vizinhancaKSaltos: recebe cada usuário encontrado e o seu
+// nível (distância em saltos) e retorna false para encerrar a consulta antes do fim.
+typedef bool (*ConsumidorVizinhos)(int idUsuario, int nivel, void* contexto);
+
+// Define um buffer do chamador para coletar os resultados de vizinhancaKSaltos (consumidor
+// coletarVizinhoNoBuffer). 'niveis' pode ser NULL quando só os IDs interessam.
+typedef struct BufferVizinhos {
+    int* ids;
+    int* niveis;
+    int capacidade;
+    int quantidade;
+} BufferVizinhos;
+
+// Consumidor que guarda os resultados em um BufferVizinhos e encerra a consulta quando ele enche.
+bool coletarVizinhoNoBuffer(int idUsuario, int nivel, void* contexto) {
+    BufferVizinhos* buffer = (BufferVizinhos*)contexto;
+    if (buffer->quantidade >= buffer->capacidade) return false;
+    buffer->ids[buffer->quantidade] = idUsuario;
+    if (buffer->niveis != NULL) buffer->niveis[buffer->quantidade] = nivel;
+    buffer->quantidade++;
+    return buffer->quantidade < buffer->capacidade;
+}
+
+// Busca os usuários a no máximo 'maxSaltos' saltos de 'idUsuario' (sem incluí-lo) e entrega cada um,
+// uma única vez, ao 'consumidor', sem imprimir nada. É uma BFS que não expande além do nível
+// 'maxSaltos' e para ao entregar 'maxResultados' usuários (0 ou negativo: sem limite) ou quando o
+// consumidor retorna false, usando 'area' (NULL: a área da thread chamadora). Assim o custo depende só
+// da vizinhança visitada, não do tamanho da rede.
+// Sem 'ordenarPorNivel', os usuários são entregues assim que descobertos (ordem da BFS). Com ele, cada
+// nível é completado e entregue em ordem crescente de ID, de modo que o limite corta os maiores IDs do
+// último nível. O ID deve ser válido e ativo. Retorna a quantidade de usuários entregues.
+int vizinhancaKSaltos(const RedeSocial* rede, int idUsuario, int maxSaltos, int maxResultados, bool ordenarPorNivel,
+                      ConsumidorVizinhos consumidor, void* contexto, AreaTrabalho* area) {
+    if (area == NULL) area = areaTrabalhoDaThread();
+    if (maxResultados <= 0) maxResultados = INT_MAX;
+    int* fila = area->fila;
+    reiniciarAreaTrabalho(area);
+    fila[0] = idUsuario;
+    marcarVisitado(area, idUsuario);
+    area->distancia[idUsuario] = 0;
+
+    int inicioFila = 0, fimFila = 1, entregues = 0;
+    for (int nivel = 1; nivel <= maxSaltos && inicioFila < fimFila; nivel++) {
+        // Expande o nível anterior inteiro: fila[inicioFila..fimAnterior) são os usuários do nível - 1.
+        int fimAnterior = fimFila, inicioNivel = fimFila;
+        for (; inicioFila < fimAnterior; inicioFila++) {
+            for (NoAmigo* amigo = rede->listaAmigos[fila[inicioFila]]; amigo != NULL; amigo = amigo->proximo) {
+                int v = amigo->idUsuario;
+                if (!usuarioAtivo(rede, v) || usuarioVisitado(area, v)) continue;
+                marcarVisitado(area, v);
+                area->distancia[v] = nivel;
+                fila[fimFila++] = v;
+                if (!ordenarPorNivel) {
+                    entregues++;
+                    if (!consumidor(v, nivel, contexto) || entregues >= maxResultados) return entregues;
+                }
+            }
+        }
+        if (ordenarPorNivel) {
+            // A ordem da fila dentro de um nível não altera os níveis seguintes, então ela é ordenada no lugar.
+            qsort(&fila[inicioNivel], (size_t)(fimFila - inicioNivel), sizeof(int), compararInteiros);
+            for (int i = inicioNivel; i < fimFila; i++) {
+                entregues++;
+                if (!consumidor(fila[i], nivel, contexto) || entregues >= maxResultados) return entregues;
+            }
+        }
+    }
+    return entregues;
+}
+
+// Consumidor do menu: imprime cada usuário encontrado com o seu nível ('contexto' é a rede).
+bool imprimirVizinho(int idUsuario, int nivel, void* contexto) {
+    const RedeSocial* rede = (const RedeSocial*)contexto;
+    printf("  %s (ID: %d) - Nível %d\n", nomeUsuario(rede, idUsuario), idUsuario, nivel);
+    return true;
+}
+
+// Função que mostra os usuários a no máximo 'maxSaltos' saltos de um usuário, limitados a
+// 'maxResultados' (0 para todos), na ordem da BFS ou com cada nível em ordem de ID.
+void vizinhosEmKSaltos(RedeSocial* rede, int idUsuario, int maxSaltos, int maxResultados, bool ordenarPorNivel) {
+    // Verifica se o ID do usuário é válido e se ele está ativo.
+    if (idUsuario < 0 || idUsuario >= MAX_USUARIOS || !usuarioAtivo(rede, idUsuario)) {
+        printf("Erro: ID de usuário inválido para a busca de vizinhos.\n");
+        return;
+    }
+    if (maxSaltos < 1) {
+        printf("Erro: o número de saltos deve ser pelo menos 1.\n");
+        return;
+    }
+
+    printf("\n--- Usuários a até %d salto(s) de %s (ID: %d) ---\n", maxSaltos, nomeUsuario(rede, idUsuario), idUsuario);
+    int total = vizinhancaKSaltos(rede, idUsuario, maxSaltos, maxResultados, ordenarPorNivel,
+                                  imprimirVizinho, rede, NULL);
+    if (total == 0) {
+        printf("  Nenhum usuário encontrado.\n");
+    } else if (maxResultados > 0 && total == maxResultados) {
+        printf("  (limite de %d resultados atingido)\n", maxResultados);
+    }
+}
+
+// Verifica a conectividade entre dois usuários usando uma implementação iterativa de DFS (com pilha).
+// 'area' (NULL: a área da thread chamadora) guarda a pilha e as visitas, e a busca para ao encontrar o destino.
+// Retorna true se existe um caminho entre o usuário de origem e o de destino, false caso contrário.
+bool verificarConectividade(const RedeSocial* rede, int idUsuarioOrigem, int idUsuarioDestino, AreaTrabalho* area) {
+    // Valida os IDs dos usuários e se estão ativos.
+    if (idUsuarioOrigem < 0 || idUsuarioOrigem >= MAX_USUARIOS || !usuarioAtivo(rede, idUsuarioOrigem) ||
+        idUsuarioDestino < 0 || idUsuarioDestino >= MAX_USUARIOS || !usuarioAtivo(rede, idUsuarioDestino)) {
+        printf("Erro: IDs de usuário inválidos para verificar conectividade.\n");
+        return false;
+    }
+
+    // Se origem e destino são o mesmo usuário, estão conectados.
+    if (idUsuarioOrigem == idUsuarioDestino) return true;
+
+    // A área marca os usuários visitados e guarda a pilha da DFS iterativa.
+    if (area == NULL) area = areaTrabalhoDaThread();
+    reiniciarAreaTrabalho(area);
+    int* pilha = area->fila;
+    // Topo da pilha.
+    int topoPilha = -1;
+
+    // Empilha o usuário de origem e marca como visitado.
+    pilha[++topoPilha] = idUsuarioOrigem;
+    marcarVisitado(area, idUsuarioOrigem);
+
+    // Loop enquanto a pilha não estiver vazia.
+    while (topoPilha != -1) {
+        // Desempilha um usuário.
+        int u = pilha[topoPilha--];
+
+        // Se o usuário desempilhado é o destino, eles estão conectados.
         if (u == idUsuarioDestino) return true;
 
         // Percorre os amigos do usuário 'u'.
-        NoAmigo* amigo = rede->usuarios[u].listaAmigos;
+        NoAmigo* amigo = rede->listaAmigos[u];
         while (amigo != NULL) {
             int v = amigo->idUsuario;
             // Se o amigo 'v' está ativo e não foi visitado.
-            if (rede->usuarios[v].ativo && !visitado[v]) {
-                visitado[v] = true; // Marca como visitado.
+            if (usuarioAtivo(rede, v) && !usuarioVisitado(area, v)) {
+                marcarVisitado(area, v); // Marca como visitado.
                 pilha[++topoPilha] = v; // Empilha para visitar.
             }
             amigo = amigo->proximo;
@@ -381,14 +2258,15 @@ bool verificarConectividade(RedeSocial* rede, int idUsuarioOrigem, int idUsuario
 // Utiliza DFSUtil para encontrar todos os membros do mesmo grupo que o usuário inicial.
 void explorarGrupos(RedeSocial* rede, int idUsuarioInicio) {
     // Verifica se o ID do usuário inicial é válido e se ele está ativo.
-    if (idUsuarioInicio < 0 || idUsuarioInicio >= MAX_USUARIOS || !rede->usuarios[idUsuarioInicio].ativo) {
+    if (idUsuarioInicio < 0 || idUsuarioInicio >= MAX_USUARIOS || !usuarioAtivo(rede, idUsuarioInicio)) {
         printf("Erro: ID de usuário inválido para explorar grupos.\n");
         return;
     }
 
-    printf("\n--- Explorando Grupo Social de %s (ID: %d) ---\n", rede->usuarios[idUsuarioInicio].nome, idUsuarioInicio);
-    // Array para marcar usuários visitados.
-    bool visitado[MAX_USUARIOS] = {false};
+    printf("\n--- Explorando Grupo Social de %s (ID: %d) ---\n", nomeUsuario(rede, idUsuarioInicio), idUsuarioInicio);
+    // Os usuários visitados são marcados na área da thread, reiniciada em O(1).
+    AreaTrabalho* area = areaTrabalhoDaThread();
+    reiniciarAreaTrabalho(area);
     // Array para armazenar os IDs dos usuários no mesmo grupo.
     int grupo[MAX_USUARIOS];
     // Contador para o número de membros no grupo.
@@ -396,30 +2274,496 @@ void explorarGrupos(RedeSocial* rede, int idUsuarioInicio) {
 
     // Chama DFSUtil para encontrar todos os usuários conectados ao usuário inicial.
     // Os membros encontrados serão armazenados no array 'grupo'.
-    DFSUtil(rede, idUsuarioInicio, visitado, grupo, &contadorGrupo);
+    DFSUtil(rede, idUsuarioInicio, area, grupo, &contadorGrupo);
 
     // Se membros foram encontrados no grupo.
     if (contadorGrupo > 0) {
         printf("Membros do grupo:\n");
         // Lista todos os membros do grupo.
         for (int i = 0; i < contadorGrupo; i++) {
-            printf("  - %s (ID: %d)\n", rede->usuarios[grupo[i]].nome, grupo[i]);
+            printf("  - %s (ID: %d)\n", nomeUsuario(rede, grupo[i]), grupo[i]);
         }
     } else {
         printf("Nenhum membro encontrado (o usuário pode estar isolado ou inativo).\n");
     }
 }
 
-// Função para liberar toda a memória alocada dinamicamente para a rede social.
-// Libera as listas de amigos de cada usuário e depois a própria estrutura da rede.
-void liberarRedeSocial(RedeSocial* rede) {
-    // Se a rede for NULL, não há nada a fazer.
-    if (rede == NULL) return;
+// ---------------------------------------------------------------------------------------------
+// Execução particionada em vários processos.
+// A faixa de IDs é dividida em partições contíguas, e cada partição fica em um segmento de memória
+// compartilhada próprio (mmap anônimo compartilhado, criado antes do fork), atendido por um processo
+// trabalhador. A BFS é síncrona em superpassos (BSP): cada processo expande a fronteira da sua partição,
+// marca diretamente os amigos locais e envia os remotos ao processo dono por anéis SPSC sem travas;
+// uma barreira entre processos separa a fase de envio da fase de recebimento.
+// Só são usados recursos portáveis (fork, pipe, mmap e atômicos do C11): o macOS, por exemplo, não tem
+// pthread_barrier_t nem prctl.
+// ---------------------------------------------------------------------------------------------
+
+// Comandos que o processo da partição 0 (o chamador) passa aos demais trabalhadores pelos pipes de
+// comando. O fim do pipe (o pai fechou a ponta de escrita ou morreu) encerra o trabalhador.
+#define COMANDO_PARTICAO_BFS 1
+
+// Esperas na barreira entre verificações de que o processo pai ainda existe.
+#define ESPERAS_ENTRE_VERIFICACOES_DO_PAI 1024
+
+// Define um anel de mensagens de produtor único e consumidor único (SPSC) em memória compartilhada.
+// O produtor só escreve 'cauda' e o consumidor só escreve 'cabeca', em linhas de cache separadas;
+// a publicação da cauda com memory_order_release torna a mensagem visível sem nenhuma trava.
+// A capacidade é a potência de 2 que cobre a partição de destino: como cada processo envia cada
+// usuário remoto no máximo uma vez por superpasso e o anel é esvaziado antes do próximo, ele nunca enche.
+typedef struct AnelMensagens {
+    _Alignas(64) atomic_ulong cabeca;   // Próxima posição a ler (escrita só pelo consumidor).
+    _Alignas(64) atomic_ulong cauda;    // Próxima posição a escrever (escrita só pelo produtor).
+    _Alignas(64) unsigned long mascara; // Capacidade - 1.
+    int mensagens[];                    // IDs dos usuários descobertos pelo produtor.
+} AnelMensagens;
+
+// Define o segmento compartilhado de uma partição: os amigos dos seus usuários em formato CSR, os níveis
+// da BFS e os anéis pelos quais os outros processos enviam usuários a ela. Os ponteiros apontam para
+// dentro do próprio segmento, que tem o mesmo endereço em todos os processos (mapeado antes do fork).
+typedef struct ParticaoCompartilhada {
+    int inicio, fim;                     // IDs da partição: [inicio, fim).
+    int usuarios;                        // Usuários ativos da partição.
+    long arestas;                        // Extremidades de amizade dos usuários da partição.
+    long arestasCortadas;                // Extremidades cujo amigo está em outra partição.
+    size_t* adjacencia;                  // Amigos de inicio + i: destinos[adjacencia[i]] até destinos[adjacencia[i + 1] - 1].
+    int* destinos;
+    int* nivel;                          // Nível de inicio + i na última BFS (-1: não alcançado).
+    AnelMensagens* aneis[MAX_PARTICOES]; // aneis[q]: mensagens do processo q (NULL para a própria partição).
+} ParticaoCompartilhada;
+
+// Define uma barreira entre processos feita só com atômicos em memória compartilhada. Cada processo lê
+// a fase atual e soma 1 às chegadas; o último a chegar zera as chegadas e avança a fase, liberando os
+// outros, que esperam a fase mudar. Dentro de uma BFS as esperas são curtas, por isso a espera é ativa
+// (com sched_yield); entre consultas os trabalhadores dormem no pipe de comando.
+typedef struct BarreiraParticionada {
+    _Alignas(64) atomic_int chegadas;    // Processos que já chegaram na fase atual.
+    _Alignas(64) atomic_uint fase;       // Número de vezes que a barreira já abriu.
+    int participantes;                   // Número de processos da execução.
+} BarreiraParticionada;
+
+// Define o segmento de controle, compartilhado por todos os processos da execução.
+typedef struct ControleParticionado {
+    BarreiraParticionada barreira;       // Barreira entre os processos da execução.
+    int origem;                          // Usuário de origem da BFS.
+    int superpassos;                     // Superpassos da última BFS.
+    long* mensagens;                     // mensagens[s * numParticoes + p]: usuários enviados por p no superpasso s.
+    long* fronteira;                     // fronteira[s * numParticoes + p]: usuários de p no nível s.
+    uint8_t dono[MAX_USUARIOS];          // Partição dona de cada usuário.
+} ControleParticionado;
+
+// Define uma execução particionada: os segmentos compartilhados, os processos trabalhadores e o estado
+// privado de cada processo (cada um fica com a sua cópia depois do fork).
+typedef struct ExecucaoParticionada {
+    int numParticoes;
+    ControleParticionado* controle;
+    size_t tamanhoControle;
+    ParticaoCompartilhada* particoes[MAX_PARTICOES];
+    size_t tamanhoParticao[MAX_PARTICOES];
+    pid_t processos[MAX_PARTICOES];      // Trabalhadores das partições 1 em diante (a 0 é o próprio chamador).
+    int pipesComando[MAX_PARTICOES];     // Ponta de escrita do pipe de comando de cada trabalhador (só no pai).
+    pid_t pai;                           // No trabalhador, o PID do processo pai (0 no próprio pai).
+    uint32_t geracaoEnvio;               // Geração do superpasso atual (como na AreaTrabalho).
+    uint32_t* ultimoEnvio;               // Geração em que cada usuário remoto foi enviado pela última vez.
+    int* fronteira;                      // Usuários da partição no nível atual.
+    int* proxima;                        // Usuários da partição descobertos para o próximo nível.
+} ExecucaoParticionada;
+
+// Reserva 'bytes' (alinhados a 64) no fim de um segmento de 'tamanho' bytes e retorna a posição reservada.
+static size_t reservarNoSegmento(size_t* tamanho, size_t bytes) {
+    size_t posicao = (*tamanho + 63) & ~(size_t)63;
+    *tamanho = posicao + bytes;
+    return posicao;
+}
+
+// Cria um segmento de memória compartilhada com os processos que forem criados depois (zerado).
+static void* criarSegmentoCompartilhado(size_t tamanho) {
+    void* segmento = mmap(NULL, tamanho, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (segmento == MAP_FAILED) {
+        perror("Erro ao criar a memória compartilhada da execução particionada");
+        exit(EXIT_FAILURE);
+    }
+    return segmento;
+}
+
+// Espera todos os processos da execução chegarem à barreira. Um trabalhador cujo pai morreu no meio
+// da BFS nunca seria liberado, então de tempos em tempos ele confere se getppid mudou e, nesse caso,
+// encerra.
+static void esperarBarreiraParticionada(const ExecucaoParticionada* exec) {
+    BarreiraParticionada* barreira = &exec->controle->barreira;
+    unsigned fase = atomic_load_explicit(&barreira->fase, memory_order_acquire);
+    if (atomic_fetch_add_explicit(&barreira->chegadas, 1, memory_order_acq_rel) == barreira->participantes - 1) {
+        atomic_store_explicit(&barreira->chegadas, 0, memory_order_relaxed);
+        atomic_store_explicit(&barreira->fase, fase + 1, memory_order_release);
+        return;
+    }
+    for (unsigned esperas = 1; atomic_load_explicit(&barreira->fase, memory_order_acquire) == fase; esperas++) {
+        if (exec->pai != 0 && esperas % ESPERAS_ENTRE_VERIFICACOES_DO_PAI == 0 && getppid() != exec->pai) _exit(EXIT_FAILURE);
+        sched_yield();
+    }
+}
+
+// Envia um usuário pelo anel (só o processo produtor chama).
+static inline void enviarMensagemParticao(AnelMensagens* anel, int idUsuario) {
+    unsigned long cauda = atomic_load_explicit(&anel->cauda, memory_order_relaxed);
+    // Pelo dimensionamento o anel não enche; se enchesse, espera o consumidor liberar espaço.
+    while (cauda - atomic_load_explicit(&anel->cabeca, memory_order_acquire) > anel->mascara) sched_yield();
+    anel->mensagens[cauda & anel->mascara] = idUsuario;
+    atomic_store_explicit(&anel->cauda, cauda + 1, memory_order_release);
+}
+
+// Recebe um usuário do anel (só o processo consumidor chama). Retorna false se o anel estiver vazio.
+static inline bool receberMensagemParticao(AnelMensagens* anel, int* idUsuario) {
+    unsigned long cabeca = atomic_load_explicit(&anel->cabeca, memory_order_relaxed);
+    if (cabeca == atomic_load_explicit(&anel->cauda, memory_order_acquire)) return false;
+    *idUsuario = anel->mensagens[cabeca & anel->mascara];
+    atomic_store_explicit(&anel->cabeca, cabeca + 1, memory_order_release);
+    return true;
+}
+
+// Retorna o nível do usuário 'id' na última BFS particionada (-1 se não foi alcançado).
+static inline int nivelParticionado(const ExecucaoParticionada* exec, int id) {
+    const ParticaoCompartilhada* particao = exec->particoes[exec->controle->dono[id]];
+    return particao->nivel[id - particao->inicio];
+}
+
+// Executa a parte da BFS que cabe à partição 'p', em sincronia com os outros processos.
+// Cada superpasso tem duas fases separadas por barreiras: na expansão, a fronteira local é percorrida,
+// os amigos locais ainda não alcançados entram no próximo nível e os remotos são enviados (uma vez por
+// superpasso) ao processo dono; no recebimento, cada processo esvazia os seus anéis. A BFS termina quando
+// nenhuma partição tem usuários no nível atual.
+static void executarBFSNaParticao(ExecucaoParticionada* exec, int p) {
+    ControleParticionado* controle = exec->controle;
+    ParticaoCompartilhada* particao = exec->particoes[p];
+    int numParticoes = exec->numParticoes;
+    int origem = controle->origem;
+
+    int tamanhoFronteira = 0;
+    for (int i = 0; i < particao->fim - particao->inicio; i++) particao->nivel[i] = -1;
+    if (origem >= particao->inicio && origem < particao->fim) {
+        particao->nivel[origem - particao->inicio] = 0;
+        exec->fronteira[tamanhoFronteira++] = origem;
+    }
+    controle->fronteira[p] = tamanhoFronteira;
+    esperarBarreiraParticionada(exec);
+
+    int superpasso = 0;
+    for (;;) {
+        long ativos = 0;
+        for (int q = 0; q < numParticoes; q++) {
+            ativos += controle->fronteira[(size_t)superpasso * (size_t)numParticoes + (size_t)q];
+        }
+        if (ativos == 0) break;
+
+        // Fase de expansão. A nova geração esquece em O(1) os envios do superpasso anterior.
+        if (++exec->geracaoEnvio == 0) {
+            memset(exec->ultimoEnvio, 0, MAX_USUARIOS * sizeof(uint32_t));
+            exec->geracaoEnvio = 1;
+        }
+        int tamanhoProxima = 0;
+        long enviadas = 0;
+        for (int i = 0; i < tamanhoFronteira; i++) {
+            int local = exec->fronteira[i] - particao->inicio;
+            for (size_t k = particao->adjacencia[local]; k < particao->adjacencia[local + 1]; k++) {
+                int v = particao->destinos[k];
+                int dono = controle->dono[v];
+                if (dono == p) {
+                    if (particao->nivel[v - particao->inicio] < 0) {
+                        particao->nivel[v - particao->inicio] = superpasso + 1;
+                        exec->proxima[tamanhoProxima++] = v;
+                    }
+                } else if (exec->ultimoEnvio[v] != exec->geracaoEnvio) {
+                    exec->ultimoEnvio[v] = exec->geracaoEnvio;
+                    enviarMensagemParticao(exec->particoes[dono]->aneis[p], v);
+                    enviadas++;
+                }
+            }
+        }
+        controle->mensagens[(size_t)superpasso * (size_t)numParticoes + (size_t)p] = enviadas;
+        esperarBarreiraParticionada(exec);
+
+        // Fase de recebimento: os usuários enviados por outras partições que ainda não têm nível.
+        for (int q = 0; q < numParticoes; q++) {
+            if (q == p) continue;
+            int v;
+            while (receberMensagemParticao(particao->aneis[q], &v)) {
+                if (particao->nivel[v - particao->inicio] < 0) {
+                    particao->nivel[v - particao->inicio] = superpasso + 1;
+                    exec->proxima[tamanhoProxima++] = v;
+                }
+            }
+        }
+        controle->fronteira[(size_t)(superpasso + 1) * (size_t)numParticoes + (size_t)p] = tamanhoProxima;
+        int* temporario = exec->fronteira;
+        exec->fronteira = exec->proxima;
+        exec->proxima = temporario;
+        tamanhoFronteira = tamanhoProxima;
+        superpasso++;
+        esperarBarreiraParticionada(exec);
+    }
+    if (p == 0) controle->superpassos = superpasso;
+}
+
+// Laço dos processos trabalhadores: dorme no pipe de comando e executa cada comando recebido. O fim do
+// pipe significa que o pai encerrou a execução ou morreu; em ambos os casos o trabalhador termina.
+static void executarTrabalhadorParticao(ExecucaoParticionada* exec, int p, int pipeComando) {
+    for (;;) {
+        unsigned char comando;
+        ssize_t lidos = read(pipeComando, &comando, 1);
+        if (lidos < 0 && errno == EINTR) continue;
+        if (lidos <= 0) _exit(0);
+        if (comando == COMANDO_PARTICAO_BFS) executarBFSNaParticao(exec, p);
+    }
+}
+
+// Divide a rede em 'numParticoes' partições e cria um processo trabalhador para cada partição além da
+// primeira (que é atendida pelo próprio chamador). As partições são faixas contíguas de IDs com pesos
+// equilibrados (1 por usuário ativo mais 1 por extremidade de amizade) e recebem uma cópia da rede no
+// momento da criação: amizades criadas depois não aparecem na execução. O resultado pertence ao chamador
+// (liberarExecucaoParticionada encerra os processos).
+ExecucaoParticionada* criarExecucaoParticionada(const RedeSocial* rede, int numParticoes) {
+    ExecucaoParticionada* exec = (ExecucaoParticionada*)calloc(1, sizeof(ExecucaoParticionada));
+    int* grau = (int*)calloc(MAX_USUARIOS, sizeof(int));
+    if (!exec || !grau) {
+        perror("Erro ao alocar memória para a execução particionada");
+        exit(EXIT_FAILURE);
+    }
+    exec->numParticoes = numParticoes;
+
+    // Graus (só amizades entre usuários ativos) e limites das partições.
+    long pesoTotal = 0;
+    for (int u = 0; u < MAX_USUARIOS; u++) {
+        if (!usuarioAtivo(rede, u)) continue;
+        for (NoAmigo* amigo = rede->listaAmigos[u]; amigo != NULL; amigo = amigo->proximo) {
+            if (usuarioAtivo(rede, amigo->idUsuario)) grau[u]++;
+        }
+        pesoTotal += 1 + grau[u];
+    }
+    int inicioParticao[MAX_PARTICOES + 1];
+    int particao = 0;
+    long acumulado = 0;
+    inicioParticao[0] = 0;
+    for (int u = 0; u < MAX_USUARIOS; u++) {
+        // Fecha as partições cuja fatia do peso total já foi preenchida.
+        while (particao < numParticoes - 1 && acumulado >= pesoTotal * (particao + 1) / numParticoes) {
+            inicioParticao[++particao] = u;
+        }
+        if (usuarioAtivo(rede, u)) acumulado += 1 + grau[u];
+    }
+    while (particao < numParticoes - 1) inicioParticao[++particao] = MAX_USUARIOS;
+    inicioParticao[numParticoes] = MAX_USUARIOS;
+
+    // Segmento de controle: barreira, dono de cada usuário e contadores por superpasso.
+    size_t tamanho = sizeof(ControleParticionado);
+    size_t tamanhoContadores = (size_t)MAX_SUPERPASSOS_PARTICIONADOS * (size_t)numParticoes * sizeof(long);
+    size_t posicaoMensagens = reservarNoSegmento(&tamanho, tamanhoContadores);
+    size_t posicaoFronteira = reservarNoSegmento(&tamanho, tamanhoContadores);
+    unsigned char* base = (unsigned char*)criarSegmentoCompartilhado(tamanho);
+    ControleParticionado* controle = (ControleParticionado*)base;
+    exec->controle = controle;
+    exec->tamanhoControle = tamanho;
+    controle->mensagens = (long*)(base + posicaoMensagens);
+    controle->fronteira = (long*)(base + posicaoFronteira);
+    atomic_init(&controle->barreira.chegadas, 0);
+    atomic_init(&controle->barreira.fase, 0);
+    controle->barreira.participantes = numParticoes;
+    for (int p = 0; p < numParticoes; p++) {
+        for (int u = inicioParticao[p]; u < inicioParticao[p + 1]; u++) controle->dono[u] = (uint8_t)p;
+    }
+
+    // Um segmento por partição, com a lista de amigos em CSR, os níveis e os anéis de entrada.
+    for (int p = 0; p < numParticoes; p++) {
+        int inicio = inicioParticao[p], fim = inicioParticao[p + 1];
+        size_t arestas = 0;
+        for (int u = inicio; u < fim; u++) arestas += (size_t)grau[u];
+        unsigned long capacidade = 1;
+        while (capacidade < (unsigned long)(fim - inicio)) capacidade *= 2;
+
+        tamanho = sizeof(ParticaoCompartilhada);
+        size_t posicaoAdjacencia = reservarNoSegmento(&tamanho, (size_t)(fim - inicio + 1) * sizeof(size_t));
+        size_t posicaoDestinos = reservarNoSegmento(&tamanho, arestas * sizeof(int));
+        size_t posicaoNivel = reservarNoSegmento(&tamanho, (size_t)(fim - inicio) * sizeof(int));
+        size_t posicaoAneis[MAX_PARTICOES];
+        for (int q = 0; q < numParticoes; q++) {
+            if (q != p) posicaoAneis[q] = reservarNoSegmento(&tamanho, sizeof(AnelMensagens) + capacidade * sizeof(int));
+        }
+        base = (unsigned char*)criarSegmentoCompartilhado(tamanho);
+        ParticaoCompartilhada* segmento = (ParticaoCompartilhada*)base;
+        exec->particoes[p] = segmento;
+        exec->tamanhoParticao[p] = tamanho;
+        segmento->inicio = inicio;
+        segmento->fim = fim;
+        segmento->adjacencia = (size_t*)(base + posicaoAdjacencia);
+        segmento->destinos = (int*)(base + posicaoDestinos);
+        segmento->nivel = (int*)(base + posicaoNivel);
+        for (int q = 0; q < numParticoes; q++) {
+            if (q == p) continue;
+            segmento->aneis[q] = (AnelMensagens*)(base + posicaoAneis[q]);
+            atomic_init(&segmento->aneis[q]->cabeca, 0);
+            atomic_init(&segmento->aneis[q]->cauda, 0);
+            segmento->aneis[q]->mascara = capacidade - 1;
+        }
+
+        // Copia as amizades e mede o corte (extremidades que apontam para outra partição).
+        size_t posicao = 0;
+        for (int u = inicio; u < fim; u++) {
+            segmento->adjacencia[u - inicio] = posicao;
+            if (!usuarioAtivo(rede, u)) continue;
+            segmento->usuarios++;
+            for (NoAmigo* amigo = rede->listaAmigos[u]; amigo != NULL; amigo = amigo->proximo) {
+                int v = amigo->idUsuario;
+                if (!usuarioAtivo(rede, v)) continue;
+                segmento->destinos[posicao++] = v;
+                if (controle->dono[v] != p) segmento->arestasCortadas++;
+            }
+        }
+        segmento->adjacencia[fim - inicio] = posicao;
+        segmento->arestas = (long)posicao;
+    }
+    free(grau);
+
+    // Estado privado (copiado para cada trabalhador no fork).
+    exec->ultimoEnvio = (uint32_t*)calloc(MAX_USUARIOS, sizeof(uint32_t));
+    exec->fronteira = (int*)malloc(MAX_USUARIOS * sizeof(int));
+    exec->proxima = (int*)malloc(MAX_USUARIOS * sizeof(int));
+    if (!exec->ultimoEnvio || !exec->fronteira || !exec->proxima) {
+        perror("Erro ao alocar memória para a execução particionada");
+        exit(EXIT_FAILURE);
+    }
+
+    // Cria os trabalhadores das partições 1 em diante, cada um com um pipe de comando cuja ponta de
+    // escrita só o pai mantém aberta: se o pai morrer, o trabalhador recebe o fim do pipe e termina.
+    pid_t pai = getpid();
+    for (int p = 1; p < numParticoes; p++) {
+        int pipeComando[2];
+        if (pipe(pipeComando) < 0) {
+            perror("Erro ao criar o pipe de comando da execução particionada");
+            exit(EXIT_FAILURE);
+        }
+        pid_t processo = fork();
+        if (processo < 0) {
+            perror("Erro ao criar o processo trabalhador da execução particionada");
+            exit(EXIT_FAILURE);
+        }
+        if (processo == 0) {
+            // Fecha as pontas de escrita herdadas (a sua e as dos trabalhadores anteriores).
+            close(pipeComando[1]);
+            for (int q = 1; q < p; q++) close(exec->pipesComando[q]);
+            exec->pai = pai;
+            executarTrabalhadorParticao(exec, p, pipeComando[0]);
+        }
+        close(pipeComando[0]);
+        exec->processos[p] = processo;
+        exec->pipesComando[p] = pipeComando[1];
+    }
+    return exec;
+}
+
+// Passa um comando a todos os trabalhadores (os parâmetros já devem estar no segmento de controle).
+static void enviarComandoParticao(ExecucaoParticionada* exec, unsigned char comando) {
+    for (int p = 1; p < exec->numParticoes; p++) {
+        while (write(exec->pipesComando[p], &comando, 1) != 1) {
+            if (errno != EINTR) {
+                perror("Erro ao enviar comando ao trabalhador da execução particionada");
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+}
+
+// Executa uma BFS particionada a partir do usuário 'origem' (ID válido e ativo), sem imprimir nada.
+// O chamador atende a partição 0. Os níveis ficam nas partições (nivelParticionado) e os contadores
+// de cada superpasso no segmento de controle. Retorna o número de superpassos.
+int BFSParticionada(ExecucaoParticionada* exec, int origem) {
+    exec->controle->origem = origem;
+    enviarComandoParticao(exec, COMANDO_PARTICAO_BFS);
+    executarBFSNaParticao(exec, 0);
+    return exec->controle->superpassos;
+}
+
+// Encerra os processos trabalhadores e libera os segmentos compartilhados e o estado privado.
+void liberarExecucaoParticionada(ExecucaoParticionada* exec) {
+    if (exec == NULL) return;
+    // Fechar os pipes de comando encerra os trabalhadores.
+    for (int p = 1; p < exec->numParticoes; p++) close(exec->pipesComando[p]);
+    for (int p = 1; p < exec->numParticoes; p++) waitpid(exec->processos[p], NULL, 0);
+    for (int p = 0; p < exec->numParticoes; p++) munmap(exec->particoes[p], exec->tamanhoParticao[p]);
+    munmap(exec->controle, exec->tamanhoControle);
+    free(exec->ultimoEnvio);
+    free(exec->fronteira);
+    free(exec->proxima);
+    free(exec);
+}
+
+// Função que executa uma BFS dividida em 'numParticoes' processos e mostra as partições com o seu corte,
+// as mensagens trocadas em cada superpasso e os usuários alcançados por nível.
+void BFSEmParticoes(RedeSocial* rede, int idUsuarioInicio, int numParticoes) {
+    // Verifica se o ID do usuário inicial é válido e se ele está ativo.
+    if (idUsuarioInicio < 0 || idUsuarioInicio >= MAX_USUARIOS || !usuarioAtivo(rede, idUsuarioInicio)) {
+        printf("Erro: ID de usuário inicial inválido para BFS.\n");
+        return;
+    }
+    if (numParticoes < 1 || numParticoes > MAX_PARTICOES) {
+        printf("Erro: o número de processos deve estar entre 1 e %d.\n", MAX_PARTICOES);
+        return;
+    }
+
+    printf("\n--- BFS a partir de %s (ID: %d) em %d processo(s) ---\n",
+           nomeUsuario(rede, idUsuarioInicio), idUsuarioInicio, numParticoes);
+    ExecucaoParticionada* exec = criarExecucaoParticionada(rede, numParticoes);
+    double inicio = agoraMicrossegundos();
+    int superpassos = BFSParticionada(exec, idUsuarioInicio);
+    double tempo = agoraMicrossegundos() - inicio;
+
+    // Partições e corte (cada amizade tem uma extremidade em cada usuário).
+    long arestas = 0, arestasCortadas = 0;
+    printf("Partições (faixas de IDs equilibradas por usuários + amizades):\n");
+    for (int p = 0; p < numParticoes; p++) {
+        const ParticaoCompartilhada* particao = exec->particoes[p];
+        if (particao->fim > particao->inicio) {
+            printf("  Processo %d: IDs %d a %d, %d usuário(s), %ld extremidade(s) de amizade, %ld cortada(s)\n", p,
+                   particao->inicio, particao->fim - 1, particao->usuarios, particao->arestas, particao->arestasCortadas);
+        } else {
+            printf("  Processo %d: partição vazia\n", p);
+        }
+        arestas += particao->arestas;
+        arestasCortadas += particao->arestasCortadas;
+    }
+    printf("Corte: %ld de %ld amizade(s) (%.1f%%) ligam partições diferentes.\n", arestasCortadas / 2, arestas / 2,
+           arestas > 0 ? 100.0 * (double)arestasCortadas / (double)arestas : 0.0);
+
+    // Volume de mensagens por superpasso.
+    printf("Superpasso | Fronteira | Mensagens | Bytes\n");
+    for (int s = 0; s < superpassos; s++) {
+        long fronteira = 0, mensagens = 0;
+        for (int p = 0; p < numParticoes; p++) {
+            fronteira += exec->controle->fronteira[(size_t)s * (size_t)numParticoes + (size_t)p];
+            mensagens += exec->controle->mensagens[(size_t)s * (size_t)numParticoes + (size_t)p];
+        }
+        printf("%10d | %9ld | %9ld | %ld\n", s, fronteira, mensagens, mensagens * (long)sizeof(int));
+    }
+
+    printf("Usuários alcançáveis e suas distâncias (níveis):\n");
+    printf("  %s (ID: %d) - Nível 0 (você mesmo)\n", nomeUsuario(rede, idUsuarioInicio), idUsuarioInicio);
+    // O último superpasso não descobre ninguém: os níveis vão de 1 a superpassos - 1.
+    for (int nivel = 1; nivel < superpassos; nivel++) {
+        for (int id = 0; id < MAX_USUARIOS; id++) {
+            if (nivelParticionado(exec, id) == nivel) {
+                printf("  %s (ID: %d) - Nível %d\n", nomeUsuario(rede, id), id, nivel);
+            }
+        }
+    }
+    printf("Calculado em %.2f ms em %d superpasso(s).\n", tempo / 1e3, superpassos);
+    liberarExecucaoParticionada(exec);
+}
+
+// Função que libera as listas de amigos de todos os usuários da rede.
+void liberarListasDeAmigos(RedeSocial* rede) {
     // Itera por todos os possíveis slots de usuário.
     for (int i = 0; i < MAX_USUARIOS; i++) {
         // Se o usuário estiver ativo (e, portanto, pode ter uma lista de amigos alocada).
-        if (rede->usuarios[i].ativo) {
-            NoAmigo* atual = rede->usuarios[i].listaAmigos;
+        if (usuarioAtivo(rede, i)) {
+            NoAmigo* atual = rede->listaAmigos[i];
             // Percorre a lista de amigos do usuário, liberando cada nó.
             while (atual != NULL) {
                 NoAmigo* temp = atual; // Guarda o nó atual.
@@ -427,14 +2771,47 @@ void liberarRedeSocial(RedeSocial* rede) {
                 free(temp);             // Libera o nó guardado.
             }
             // Define a lista de amigos como NULL após liberar todos os nós.
-            rede->usuarios[i].listaAmigos = NULL;
+            rede->listaAmigos[i] = NULL;
         }
     }
+}
+
+// Função para liberar toda a memória alocada dinamicamente para a rede social.
+// Libera as listas de amigos de cada usuário e depois a própria estrutura da rede.
+void liberarRedeSocial(RedeSocial* rede) {
+    // Se a rede for NULL, não há nada a fazer.
+    if (rede == NULL) return;
+    liberarListasDeAmigos(rede);
+    liberarOraculoDistancias(rede->oraculo);
     // Libera a memória da própria estrutura da rede social.
     free(rede);
     printf("Memória da rede social liberada.\n");
 }
 
+// Função que cria uma cópia independente da rede (estrutura e listas de amigos).
+// A cópia não tem journal associado: é usada como snapshot imutável pelo modo servidor.
+RedeSocial* clonarRedeSocial(const RedeSocial* rede) {
+    RedeSocial* copia = (RedeSocial*)malloc(sizeof(RedeSocial));
+    if (!copia) {
+        perror("Erro ao alocar memória para a cópia da RedeSocial");
+        exit(EXIT_FAILURE);
+    }
+    // Copia de uma vez os arrays de tamanho fixo (bitmap, nomes, contadores, versão, índice de similares).
+    memcpy(copia, rede, sizeof(RedeSocial));
+    copia->journal = NULL;
+    copia->oraculo = NULL; // O oráculo pertence à rede original.
+    // Copia as listas de amigos, preservando a ordem dos nós.
+    for (int i = 0; i < MAX_USUARIOS; i++) {
+        NoAmigo** destino = &copia->listaAmigos[i];
+        for (NoAmigo* amigo = rede->listaAmigos[i]; amigo != NULL; amigo = amigo->proximo) {
+            *destino = criarNoAmigo(amigo->idUsuario);
+            destino = &(*destino)->proximo;
+        }
+        *destino = NULL;
+    }
+    return copia;
+}
+
 // Função para exibir o menu principal de opções da rede social.
 void exibirMenuRedeSocial() {
     printf("\n--- Rede Social Simulada ---\n");
@@ -447,6 +2824,12 @@ void exibirMenuRedeSocial() {
     printf("7. Explorar Grupo Social de um Usuário\n");
     printf("8. Verificar Conectividade entre dois Usuários\n");
     printf("9. Listar todos os usuários ativos\n");
+    printf("10. Buscar Usuários Similares (MinHash/LSH)\n");
+    printf("11. Distância entre dois Usuários (Oráculo de Marcos)\n");
+    printf("12. Alcance em k Saltos e Função de Vizinhança (HyperANF)\n");
+    printf("13. Triângulos e Coeficientes de Agrupamento\n");
+    printf("14. Usuários a até k Saltos de um Usuário\n");
+    printf("15. BFS Particionada em Vários Processos\n");
     printf("0. Sair\n");
     printf("Escolha uma opção: ");
 }
@@ -458,8 +2841,8 @@ void listarUsuariosAtivos(RedeSocial* rede) {
     // Itera por todos os possíveis slots de usuário.
     for (int i = 0; i < MAX_USUARIOS; i++) {
         // Se o usuário no slot 'i' estiver ativo.
-        if (rede->usuarios[i].ativo) {
-            printf("ID: %d, Nome: %s\n", rede->usuarios[i].id, rede->usuarios[i].nome);
+        if (usuarioAtivo(rede, i)) {
+            printf("ID: %d, Nome: %s\n", i, nomeUsuario(rede, i));
             count++;
         }
     }
@@ -470,8 +2853,764 @@ void listarUsuariosAtivos(RedeSocial* rede) {
 }
 
 
+// Define a requisição do protocolo binário do servidor (tamanho fixo de 16 bytes).
+typedef struct RequisicaoServidor {
+    uint8_t operacao;         // Código da operação (OP_SERVIDOR_*).
+    uint8_t reservado[3];     // Não usado (alinhamento).
+    int32_t argumentos[3];    // Argumentos da operação (IDs de usuários).
+} RequisicaoServidor;
+
+// Define o cabeçalho da resposta do servidor. Ele é seguido por 'quantidade' inteiros de 32 bits.
+typedef struct CabecalhoResposta {
+    int32_t status;           // STATUS_OK ou um código de erro.
+    uint32_t versao;          // Versão do snapshot que respondeu à consulta (ou criada pela escrita).
+    uint32_t quantidade;      // Número de inteiros int32 que seguem o cabeçalho.
+} CabecalhoResposta;
+
+// Define um item da fila do pool: um cliente e a requisição completa que o laço de eventos recebeu dele.
+typedef struct ClientePronto {
+    int cliente;
+    RequisicaoServidor requisicao;
+} ClientePronto;
+
+// Define o estado do servidor de consultas.
+// Os leitores nunca usam a rede mutável: eles consultam um snapshot imutável, publicado por troca
+// atômica de ponteiro no estilo RCU. Cada trabalhador anuncia em 'snapshotEmUso' o snapshot que está
+// lendo; o escritor só libera um snapshot antigo depois que nenhum trabalhador o anuncia mais.
+// Assim as escritas nunca bloqueiam consultas em andamento (quem espera é o escritor).
+typedef struct Servidor {
+    RedeSocial* rede;                                       // Rede mutável, alterada só sob 'mutexEscrita'.
+    _Atomic(RedeSocial*) snapshotAtual;                     // Snapshot imutável mais recente.
+    _Atomic(RedeSocial*) snapshotEmUso[NUM_TRABALHADORES];  // Snapshot lido por cada trabalhador (NULL: nenhum).
+    pthread_mutex_t mutexEscrita;                           // Serializa as escritas (e o buffer do journal).
+    unsigned long escritasRegistradas;                      // Escritas aceitas até agora (sob 'mutexEscrita').
+    pthread_mutex_t mutexConfirmacao;                       // Protege os dois campos abaixo (group commit).
+    pthread_cond_t condicaoConfirmacao;                     // Sinaliza o fim de cada fsync do journal.
+    unsigned long escritasConfirmadas;                      // Escritas que um fsync já tornou duráveis.
+    bool confirmando;                                       // Algum trabalhador está fazendo o fsync de um lote.
+    pthread_mutex_t mutexFila;                              // Protege a fila de clientes prontos.
+    pthread_cond_t condicaoFila;                            // Sinaliza clientes novos na fila.
+    ClientePronto filaClientes[MAX_CLIENTES];               // Fila circular de clientes com requisição completa.
+    int inicioFila, tamanhoFila;
+    int pipeDevolucao[2];                                   // Trabalhadores devolvem por aqui os clientes atendidos.
+    bool encerrando;                                        // Indica aos trabalhadores que o servidor está parando.
+    // Estatísticas das consultas de cada trabalhador (só com "--estatisticas"; somadas no encerramento).
+    AgregadoEstatisticas estatisticas[NUM_TRABALHADORES][NUM_OPERACOES_ESTATISTICAS];
+} Servidor;
+
+// Define os argumentos de cada thread trabalhadora.
+typedef struct ArgumentoTrabalhador {
+    Servidor* servidor;
+    int indice;               // Índice do trabalhador (posição em 'snapshotEmUso').
+} ArgumentoTrabalhador;
+
+// Sinalizado por SIGINT/SIGTERM para encerrar o laço de eventos.
+static volatile sig_atomic_t servidorDeveEncerrar = 0;
+
+// Função de tratamento de sinais do modo servidor: apenas pede o encerramento.
+void tratarSinalServidor(int sinal) {
+    (void)sinal;
+    servidorDeveEncerrar = 1;
+}
+
+// Função que escreve exatamente 'tamanho' bytes em um socket não bloqueante. Quando o socket enche,
+// espera (poll) que ele volte a aceitar dados, mas no máximo TEMPO_LIMITE_ESCRITA_MS no total: um
+// cliente que parou de ler não prende o trabalhador nem o encerramento do servidor.
+// Retorna false em caso de erro ou de tempo esgotado.
+bool escreverCompleto(int descritor, const void* origem, size_t tamanho) {
+    size_t escritos = 0;
+    double limite = agoraMicrossegundos() + TEMPO_LIMITE_ESCRITA_MS * 1000.0;
+    while (escritos < tamanho) {
+        ssize_t n = write(descritor, (const char*)origem + escritos, tamanho - escritos);
+        if (n > 0) {
+            escritos += (size_t)n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) return false;
+        int restante = (int)((limite - agoraMicrossegundos()) / 1000.0);
+        struct pollfd espera = {descritor, POLLOUT, 0};
+        if (restante <= 0 || poll(&espera, 1, restante) <= 0) return false;
+    }
+    return true;
+}
+
+// Função que coloca um descritor em modo não bloqueante. Retorna false em caso de erro.
+bool tornarNaoBloqueante(int descritor) {
+    int flags = fcntl(descritor, F_GETFL, 0);
+    return flags >= 0 && fcntl(descritor, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+// Função que obtém o snapshot atual para leitura pelo trabalhador 'indice'.
+// O anúncio em 'snapshotEmUso' é confirmado relendo 'snapshotAtual': se uma troca ocorreu no meio,
+// tenta de novo, garantindo que o escritor sempre enxergue o anúncio antes de liberar o snapshot.
+RedeSocial* adquirirSnapshot(Servidor* servidor, int indice) {
+    RedeSocial* snapshot;
+    do {
+        snapshot = atomic_load(&servidor->snapshotAtual);
+        atomic_store(&servidor->snapshotEmUso[indice], snapshot);
+    } while (snapshot != atomic_load(&servidor->snapshotAtual));
+    return snapshot;
+}
+
+// Função que encerra a leitura do trabalhador 'indice' (o snapshot pode ser liberado pelo escritor).
+void soltarSnapshot(Servidor* servidor, int indice) {
+    atomic_store(&servidor->snapshotEmUso[indice], NULL);
+}
+
+// Função que publica um novo snapshot da rede mutável (chamada pelo escritor, sob 'mutexEscrita').
+// Retorna o snapshot antigo, que o escritor libera com liberarSnapshotAntigo depois de soltar a trava.
+RedeSocial* publicarSnapshot(Servidor* servidor) {
+    RedeSocial* novo = clonarRedeSocial(servidor->rede);
+    return atomic_exchange(&servidor->snapshotAtual, novo);
+}
+
+// Função que espera os leitores que ainda usam um snapshot já substituído terminarem e o libera.
+// É chamada fora de 'mutexEscrita', para que o período de carência não atrase as outras escritas.
+void liberarSnapshotAntigo(Servidor* servidor, RedeSocial* antigo) {
+    for (int i = 0; i < NUM_TRABALHADORES; i++) {
+        while (atomic_load(&servidor->snapshotEmUso[i]) == antigo) {
+            sched_yield(); // Período de carência: aguarda o leitor terminar a consulta.
+        }
+    }
+    liberarListasDeAmigos(antigo);
+    free(antigo);
+}
+
+// Função que espera a escrita de número 'numero' ser publicada e ficar durável (group commit entre os
+// trabalhadores). Se nenhum trabalhador está confirmando um lote, este assume: sob 'mutexEscrita' grava
+// o buffer do journal no arquivo e publica um snapshot com todas as escritas registradas até ali; fora
+// dela espera os leitores do snapshot antigo e faz um único fsync para o lote. As escritas que chegam
+// enquanto isso esperam, e o primeiro a acordar confirma o lote seguinte inteiro.
+void confirmarEscritas(Servidor* servidor, unsigned long numero) {
+    pthread_mutex_lock(&servidor->mutexConfirmacao);
+    while (servidor->escritasConfirmadas < numero) {
+        if (servidor->confirmando) {
+            pthread_cond_wait(&servidor->condicaoConfirmacao, &servidor->mutexConfirmacao);
+            continue;
+        }
+        servidor->confirmando = true;
+        pthread_mutex_unlock(&servidor->mutexConfirmacao);
+
+        pthread_mutex_lock(&servidor->mutexEscrita);
+        unsigned long lote = servidor->escritasRegistradas;
+        int descritor = prepararConfirmacaoJournal(servidor->rede);
+        RedeSocial* antigo = NULL;
+        if (atomic_load(&servidor->snapshotAtual)->versao != servidor->rede->versao) antigo = publicarSnapshot(servidor);
+        pthread_mutex_unlock(&servidor->mutexEscrita);
+        if (antigo != NULL) liberarSnapshotAntigo(servidor, antigo);
+        if (descritor >= 0 && fsync(descritor) != 0) {
+            perror("Erro ao sincronizar o journal");
+            exit(EXIT_FAILURE);
+        }
+
+        pthread_mutex_lock(&servidor->mutexConfirmacao);
+        servidor->escritasConfirmadas = lote;
+        servidor->confirmando = false;
+        pthread_cond_broadcast(&servidor->condicaoConfirmacao);
+    }
+    pthread_mutex_unlock(&servidor->mutexConfirmacao);
+}
+
+// Função que verifica se um ID recebido pelo servidor é válido e ativo na rede fornecida.
+bool idUsuarioValido(const RedeSocial* rede, int32_t id) {
+    return id >= 0 && id < MAX_USUARIOS && usuarioAtivo(rede, id);
+}
+
+// Função que executa uma requisição e envia a resposta ao cliente.
+// 'dados' é o buffer de resposta do trabalhador (espaço para 2 * MAX_USUARIOS inteiros).
+// Retorna false se a resposta não pôde ser enviada.
+bool atenderRequisicao(Servidor* servidor, int indice, const RequisicaoServidor* requisicao,
+                       int cliente, int32_t* dados) {
+    CabecalhoResposta cabecalho = {STATUS_OK, 0, 0};
+    int32_t a = requisicao->argumentos[0], b = requisicao->argumentos[1];
+
+    if (requisicao->operacao == OP_SERVIDOR_CRIAR_CONEXAO) {
+        // Escrita: sob 'mutexEscrita' só altera a rede mutável e anexa o registro ao buffer do journal
+        // (conectarUsuarios não imprime nada). O snapshot e o fsync são feitos uma vez por lote em
+        // confirmarEscritas, e a resposta só é enviada depois que o lote com esta escrita estiver
+        // publicado e no disco.
+        unsigned long numeroEscrita = 0;
+        pthread_mutex_lock(&servidor->mutexEscrita);
+        if (conectarUsuarios(servidor->rede, a, b) != CONEXAO_CRIADA) {
+            cabecalho.status = STATUS_ARGUMENTO_INVALIDO;
+        } else {
+            numeroEscrita = ++servidor->escritasRegistradas;
+        }
+        cabecalho.versao = (uint32_t)servidor->rede->versao;
+        pthread_mutex_unlock(&servidor->mutexEscrita);
+        if (numeroEscrita != 0) confirmarEscritas(servidor, numeroEscrita);
+    } else {
+        // Leitura: consulta o snapshot imutável atual, sem nenhum bloqueio.
+        const RedeSocial* snapshot = adquirirSnapshot(servidor, indice);
+        cabecalho.versao = (uint32_t)snapshot->versao;
+        if (requisicao->operacao == OP_SERVIDOR_BFS) {
+            if (!idUsuarioValido(snapshot, a)) {
+                cabecalho.status = STATUS_ARGUMENTO_INVALIDO;
+            } else {
+                AreaTrabalho* area = areaTrabalhoDaThread();
+                EstatisticasConsulta estatisticas;
+                int alcancados = BFSNiveis(snapshot, a, area, estatisticasAtivas ? &estatisticas : NULL);
+                if (estatisticasAtivas) acumularEstatisticas(&servidor->estatisticas[indice][ESTATISTICAS_BFS], &estatisticas);
+                for (int i = 0; i < alcancados; i++) {
+                    dados[2 * i] = area->fila[i];
+                    dados[2 * i + 1] = area->distancia[area->fila[i]];
+                }
+                cabecalho.quantidade = (uint32_t)(2 * alcancados);
+            }
+        } else if (requisicao->operacao == OP_SERVIDOR_SUGERIR_AMIGOS) {
+            if (!idUsuarioValido(snapshot, a)) {
+                cabecalho.status = STATUS_ARGUMENTO_INVALIDO;
+            } else {
+                int sugestoes[MAX_USUARIOS], intermediarios[MAX_USUARIOS];
+                EstatisticasConsulta estatisticas;
+                int total = calcularSugestoes(snapshot, a, sugestoes, intermediarios, NULL,
+                                              estatisticasAtivas ? &estatisticas : NULL);
+                if (estatisticasAtivas) {
+                    acumularEstatisticas(&servidor->estatisticas[indice][ESTATISTICAS_SUGERIR_AMIGOS], &estatisticas);
+                }
+                for (int i = 0; i < total; i++) {
+                    dados[2 * i] = sugestoes[i];
+                    dados[2 * i + 1] = intermediarios[i];
+                }
+                cabecalho.quantidade = (uint32_t)(2 * total);
+            }
+        } else if (requisicao->operacao == OP_SERVIDOR_CONECTIVIDADE) {
+            if (!idUsuarioValido(snapshot, a) || !idUsuarioValido(snapshot, b)) {
+                cabecalho.status = STATUS_ARGUMENTO_INVALIDO;
+            } else {
+                dados[0] = verificarConectividade(snapshot, a, b, NULL) ? 1 : 0;
+                cabecalho.quantidade = 1;
+            }
+        } else if (requisicao->operacao == OP_SERVIDOR_USUARIOS_SIMILARES) {
+            if (!idUsuarioValido(snapshot, a) || b < 1 || b > MAX_RESULTADOS_SIMILARES) {
+                cabecalho.status = STATUS_ARGUMENTO_INVALIDO;
+            } else {
+                int similares[MAX_RESULTADOS_SIMILARES], coincidencias[MAX_RESULTADOS_SIMILARES];
+                int total = buscarUsuariosSimilares(snapshot, a, b, similares, coincidencias);
+                for (int i = 0; i < total; i++) {
+                    dados[2 * i] = similares[i];
+                    dados[2 * i + 1] = coincidencias[i];
+                }
+                cabecalho.quantidade = (uint32_t)(2 * total);
+            }
+        } else if (requisicao->operacao == OP_SERVIDOR_K_SALTOS) {
+            if (!idUsuarioValido(snapshot, a) || b < 0) {
+                cabecalho.status = STATUS_ARGUMENTO_INVALIDO;
+            } else {
+                // O máximo é limitado ao tamanho do buffer de resposta (0 ou negativo: sem limite).
+                int32_t maximo = requisicao->argumentos[2];
+                if (maximo <= 0 || maximo > MAX_USUARIOS) maximo = MAX_USUARIOS;
+                int ids[MAX_USUARIOS], niveis[MAX_USUARIOS];
+                BufferVizinhos buffer = {ids, niveis, maximo, 0};
+                int total = vizinhancaKSaltos(snapshot, a, b, maximo, true, coletarVizinhoNoBuffer, &buffer, NULL);
+                for (int i = 0; i < total; i++) {
+                    dados[2 * i] = ids[i];
+                    dados[2 * i + 1] = niveis[i];
+                }
+                cabecalho.quantidade = (uint32_t)(2 * total);
+            }
+        } else {
+            cabecalho.status = STATUS_OPERACAO_DESCONHECIDA;
+        }
+        soltarSnapshot(servidor, indice);
+    }
+
+    return escreverCompleto(cliente, &cabecalho, sizeof(cabecalho)) &&
+           escreverCompleto(cliente, dados, cabecalho.quantidade * sizeof(int32_t));
+}
+
+// Função executada por cada thread trabalhadora: retira da fila os clientes com uma requisição completa,
+// atende-a e os devolve ao laço de eventos pelo pipe (o ID negativo -1 - cliente indica que a
+// conexão deve ser fechada). O trabalhador nunca lê do socket, então um cliente lento não o prende.
+void* executarTrabalhador(void* argumento) {
+    ArgumentoTrabalhador* arg = (ArgumentoTrabalhador*)argumento;
+    Servidor* servidor = arg->servidor;
+    int32_t* dados = (int32_t*)malloc(2 * MAX_USUARIOS * sizeof(int32_t));
+    if (!dados) {
+        perror("Erro ao alocar memória para o buffer de resposta");
+        exit(EXIT_FAILURE);
+    }
+    for (;;) {
+        // Aguarda um cliente com requisição pendente.
+        pthread_mutex_lock(&servidor->mutexFila);
+        while (servidor->tamanhoFila == 0 && !servidor->encerrando) {
+            pthread_cond_wait(&servidor->condicaoFila, &servidor->mutexFila);
+        }
+        if (servidor->tamanhoFila == 0) { // Encerrando e sem trabalho pendente.
+            pthread_mutex_unlock(&servidor->mutexFila);
+            break;
+        }
+        ClientePronto pronto = servidor->filaClientes[servidor->inicioFila];
+        servidor->inicioFila = (servidor->inicioFila + 1) % MAX_CLIENTES;
+        servidor->tamanhoFila--;
+        pthread_mutex_unlock(&servidor->mutexFila);
+
+        // Atende a requisição; uma falha ao enviar a resposta (ou tempo esgotado) encerra o cliente.
+        bool ok = atenderRequisicao(servidor, arg->indice, &pronto.requisicao, pronto.cliente, dados);
+        int devolucao = ok ? pronto.cliente : -1 - pronto.cliente;
+        if (write(servidor->pipeDevolucao[1], &devolucao, sizeof(devolucao)) != sizeof(devolucao)) {
+            perror("Erro ao devolver cliente ao laço de eventos");
+        }
+    }
+    free(dados);
+    return NULL;
+}
+
+// Função que executa a rede social como servidor de consultas em um socket de domínio Unix.
+// O laço de eventos (poll) aceita conexões e lê as requisições dos sockets não bloqueantes, guardando
+// os bytes de cada cliente até completar os 16 da requisição; só então o cliente sai do conjunto
+// monitorado e vai, com a requisição, para a fila do pool de trabalhadores, que a atende e o devolve.
+// Assim cada cliente tem no máximo uma requisição em andamento e as respostas saem em ordem, e um
+// cliente que envia só parte de uma requisição não ocupa nenhum trabalhador.
+// Encerra com SIGINT ou SIGTERM.
+void executarServidor(RedeSocial* rede, const char* caminhoSocket) {
+    Servidor* servidor = (Servidor*)malloc(sizeof(Servidor));
+    if (!servidor) {
+        perror("Erro ao alocar memória para o servidor");
+        exit(EXIT_FAILURE);
+    }
+    servidor->rede = rede;
+    atomic_init(&servidor->snapshotAtual, clonarRedeSocial(rede));
+    for (int i = 0; i < NUM_TRABALHADORES; i++) atomic_init(&servidor->snapshotEmUso[i], NULL);
+    pthread_mutex_init(&servidor->mutexEscrita, NULL);
+    pthread_mutex_init(&servidor->mutexConfirmacao, NULL);
+    pthread_cond_init(&servidor->condicaoConfirmacao, NULL);
+    servidor->escritasRegistradas = 0;
+    servidor->escritasConfirmadas = 0;
+    servidor->confirmando = false;
+    pthread_mutex_init(&servidor->mutexFila, NULL);
+    pthread_cond_init(&servidor->condicaoFila, NULL);
+    servidor->inicioFila = 0;
+    servidor->tamanhoFila = 0;
+    servidor->encerrando = false;
+    memset(servidor->estatisticas, 0, sizeof(servidor->estatisticas));
+
+    // Cria o socket de escuta.
+    struct sockaddr_un endereco;
+    memset(&endereco, 0, sizeof(endereco));
+    endereco.sun_family = AF_UNIX;
+    if (strlen(caminhoSocket) >= sizeof(endereco.sun_path)) {
+        printf("Erro: caminho do socket muito longo.\n");
+        free(servidor);
+        return;
+    }
+    strcpy(endereco.sun_path, caminhoSocket);
+    int escuta = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(caminhoSocket); // Remove um socket antigo que tenha sobrado de outra execução.
+    if (escuta < 0 || bind(escuta, (struct sockaddr*)&endereco, sizeof(endereco)) != 0 ||
+        listen(escuta, MAX_CLIENTES) != 0 || !tornarNaoBloqueante(escuta) || pipe(servidor->pipeDevolucao) != 0) {
+        perror("Erro ao iniciar o servidor");
+        exit(EXIT_FAILURE);
+    }
+
+    // Trata os sinais: SIGINT/SIGTERM encerram; SIGPIPE (cliente que desconectou) é ignorado.
+    struct sigaction acao;
+    memset(&acao, 0, sizeof(acao));
+    acao.sa_handler = tratarSinalServidor;
+    sigaction(SIGINT, &acao, NULL);
+    sigaction(SIGTERM, &acao, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    // Inicia o pool de trabalhadores.
+    pthread_t threads[NUM_TRABALHADORES];
+    ArgumentoTrabalhador argumentos[NUM_TRABALHADORES];
+    for (int i = 0; i < NUM_TRABALHADORES; i++) {
+        argumentos[i].servidor = servidor;
+        argumentos[i].indice = i;
+        pthread_create(&threads[i], NULL, executarTrabalhador, &argumentos[i]);
+    }
+    printf("Servidor da rede social aguardando consultas em %s (versão %lu).\n", caminhoSocket, rede->versao);
+    fflush(stdout);
+
+    // Clientes conectados; 'ocupado' indica que o cliente está com um trabalhador (fora do poll) e
+    // 'recebido' guarda os bytes já lidos da próxima requisição.
+    int clientes[MAX_CLIENTES];
+    bool ocupado[MAX_CLIENTES];
+    unsigned char recebido[MAX_CLIENTES][sizeof(RequisicaoServidor)];
+    size_t bytesRecebidos[MAX_CLIENTES];
+    int numClientes = 0;
+    struct pollfd monitorados[2 + MAX_CLIENTES];
+    int indiceDoMonitorado[2 + MAX_CLIENTES];
+
+    // Laço de eventos.
+    while (!servidorDeveEncerrar) {
+        // Monta o conjunto monitorado: socket de escuta, pipe de devolução e clientes ociosos.
+        int total = 0;
+        monitorados[total].fd = escuta;
+        monitorados[total++].events = numClientes < MAX_CLIENTES ? POLLIN : 0;
+        monitorados[total].fd = servidor->pipeDevolucao[0];
+        monitorados[total++].events = POLLIN;
+        for (int i = 0; i < numClientes; i++) {
+            if (ocupado[i]) continue;
+            monitorados[total].fd = clientes[i];
+            monitorados[total].events = POLLIN;
+            indiceDoMonitorado[total++] = i;
+        }
+        // Usa um tempo limite para verificar periodicamente o pedido de encerramento.
+        if (poll(monitorados, (nfds_t)total, 500) <= 0) continue;
+
+        // Lê o que os clientes ociosos enviaram; quem completou uma requisição vai para a fila dos
+        // trabalhadores e quem desconectou é fechado. Percorre de trás para frente porque fechar um
+        // cliente move o último para a sua posição, e os de índice maior já foram tratados.
+        for (int m = total - 1; m >= 2; m--) {
+            if (monitorados[m].revents == 0) continue;
+            int i = indiceDoMonitorado[m];
+            ssize_t n = read(clientes[i], recebido[i] + bytesRecebidos[i], sizeof(RequisicaoServidor) - bytesRecebidos[i]);
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) continue;
+            if (n <= 0) {
+                close(clientes[i]);
+                numClientes--;
+                clientes[i] = clientes[numClientes];
+                ocupado[i] = ocupado[numClientes];
+                memcpy(recebido[i], recebido[numClientes], sizeof(RequisicaoServidor));
+                bytesRecebidos[i] = bytesRecebidos[numClientes];
+                continue;
+            }
+            bytesRecebidos[i] += (size_t)n;
+            if (bytesRecebidos[i] < sizeof(RequisicaoServidor)) continue;
+            ClientePronto pronto;
+            pronto.cliente = clientes[i];
+            memcpy(&pronto.requisicao, recebido[i], sizeof(RequisicaoServidor));
+            bytesRecebidos[i] = 0;
+            ocupado[i] = true;
+            pthread_mutex_lock(&servidor->mutexFila);
+            servidor->filaClientes[(servidor->inicioFila + servidor->tamanhoFila) % MAX_CLIENTES] = pronto;
+            servidor->tamanhoFila++;
+            pthread_cond_signal(&servidor->condicaoFila);
+            pthread_mutex_unlock(&servidor->mutexFila);
+        }
+        // Clientes devolvidos pelos trabalhadores voltam a ser monitorados (ou são fechados).
+        if (monitorados[1].revents & POLLIN) {
+            int devolucao;
+            if (read(servidor->pipeDevolucao[0], &devolucao, sizeof(devolucao)) == sizeof(devolucao)) {
+                int cliente = devolucao >= 0 ? devolucao : -1 - devolucao;
+                for (int i = 0; i < numClientes; i++) {
+                    if (clientes[i] != cliente) continue;
+                    if (devolucao >= 0) {
+                        ocupado[i] = false;
+                    } else {
+                        close(cliente);
+                        numClientes--;
+                        clientes[i] = clientes[numClientes];
+                        ocupado[i] = ocupado[numClientes];
+                        memcpy(recebido[i], recebido[numClientes], sizeof(RequisicaoServidor));
+                        bytesRecebidos[i] = bytesRecebidos[numClientes];
+                    }
+                    break;
+                }
+            }
+        }
+        // Aceita uma nova conexão.
+        if (monitorados[0].revents & POLLIN) {
+            int cliente = accept(escuta, NULL, NULL);
+            if (cliente >= 0 && !tornarNaoBloqueante(cliente)) {
+                close(cliente);
+            } else if (cliente >= 0) {
+                clientes[numClientes] = cliente;
+                ocupado[numClientes] = false;
+                bytesRecebidos[numClientes++] = 0;
+            }
+        }
+    }
+
+    // Encerramento: para os trabalhadores, fecha as conexões e libera o snapshot publicado.
+    printf("\nEncerrando o servidor...\n");
+    pthread_mutex_lock(&servidor->mutexFila);
+    servidor->encerrando = true;
+    pthread_cond_broadcast(&servidor->condicaoFila);
+    pthread_mutex_unlock(&servidor->mutexFila);
+    for (int i = 0; i < NUM_TRABALHADORES; i++) pthread_join(threads[i], NULL);
+    for (int i = 0; i < numClientes; i++) close(clientes[i]);
+    close(escuta);
+    close(servidor->pipeDevolucao[0]);
+    close(servidor->pipeDevolucao[1]);
+    unlink(caminhoSocket);
+    if (estatisticasAtivas) {
+        // Junta as estatísticas de todos os trabalhadores no primeiro e as relata.
+        for (int i = 1; i < NUM_TRABALHADORES; i++) {
+            for (int op = 0; op < NUM_OPERACOES_ESTATISTICAS; op++) {
+                combinarAgregados(&servidor->estatisticas[0][op], &servidor->estatisticas[i][op]);
+            }
+        }
+        imprimirHistogramas(stdout, servidor->estatisticas[0]);
+    }
+    RedeSocial* snapshot = atomic_load(&servidor->snapshotAtual);
+    liberarListasDeAmigos(snapshot);
+    free(snapshot);
+    pthread_mutex_destroy(&servidor->mutexEscrita);
+    pthread_mutex_destroy(&servidor->mutexConfirmacao);
+    pthread_cond_destroy(&servidor->condicaoConfirmacao);
+    pthread_mutex_destroy(&servidor->mutexFila);
+    pthread_cond_destroy(&servidor->condicaoFila);
+    free(servidor);
+}
+
+
+// Define as operações medidas pelo modo benchmark.
+#define BENCH_BFS 0
+#define BENCH_DFS 1                  // DFSUtil em modo grupo: é o núcleo comum de DFS e explorarGrupos.
+#define BENCH_SUGERIR_AMIGOS 2
+#define BENCH_CONECTIVIDADE 3
+#define BENCH_USUARIOS_SIMILARES 4
+#define BENCH_DISTANCIA_ORACULO 5    // Limite superior da distância pelo oráculo de marcos (sem refinamento).
+#define BENCH_K_SALTOS 6             // Vizinhança de SALTOS_BENCHMARK saltos, ordenada, com até MAX_RESULTADOS_K_SALTOS_BENCHMARK usuários.
+#define NUM_OPERACOES_BENCHMARK 7
+
+#define SALTOS_BENCHMARK 2
+#define MAX_RESULTADOS_K_SALTOS_BENCHMARK 1000
+
+// Nomes das operações no arquivo de resultados.
+static const char* const nomesOperacoesBenchmark[NUM_OPERACOES_BENCHMARK] = {
+    "BFS", "DFS/explorarGrupos", "sugerirAmigos", "verificarConectividade", "usuariosSimilares",
+    "distanciaOraculo", "vizinhancaKSaltos"
+};
+
+// Define a tarefa de uma thread do benchmark: executa 'consultas' consultas da operação sobre a rede
+// (somente leitura) e registra a latência de cada uma, em microssegundos.
+typedef struct TarefaBenchmark {
+    const RedeSocial* rede;
+    int numUsuarios;          // Os usuários gerados ocupam os IDs 0..numUsuarios-1.
+    int operacao;             // BENCH_*.
+    int consultas;            // Quantidade de consultas desta thread.
+    uint64_t semente;         // Semente do gerador pseudoaleatório desta thread.
+    double* latencias;        // Saída: latência de cada consulta.
+} TarefaBenchmark;
+
+// Gerador pseudoaleatório splitmix64: rápido, determinístico e sem estado global (seguro entre threads).
+uint64_t proximoAleatorio(uint64_t* estado) {
+    uint64_t z = (*estado += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Retorna um número real pseudoaleatório uniforme em [0, 1).
+double aleatorioReal(uint64_t* estado) {
+    return (double)(proximoAleatorio(estado) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Gera uma rede social sintética com distribuição de graus do tipo lei de potência (modelo R-MAT/Kronecker).
+// Cada aresta escolhe recursivamente um dos quatro quadrantes da matriz de adjacência com
+// probabilidades (a, b, c, d) = (0.57, 0.19, 0.19, 0.05), como no gerador do Graph500.
+// Usa as funções internas (sem impressão nem journal). Retorna o número de amizades distintas criadas.
+long gerarRedeRMAT(RedeSocial* rede, int escala, int fatorArestas, uint64_t semente) {
+    int numUsuarios = 1 << escala;
+    char nome[MAX_NOME_USUARIO];
+    for (int i = 0; i < numUsuarios; i++) {
+        int tamanhoNome = snprintf(nome, sizeof(nome), "U%d", i);
+        ativarUsuario(rede, i, nome, tamanhoNome);
+    }
+    long amizades = 0;
+    long tentativas = (long)fatorArestas * numUsuarios;
+    for (long e = 0; e < tentativas; e++) {
+        int u = 0, v = 0;
+        for (int bit = 0; bit < escala; bit++) {
+            double r = aleatorioReal(&semente);
+            if (r < 0.57) continue;                          // Quadrante a: nenhum bit.
+            else if (r < 0.76) v |= 1 << bit;                // Quadrante b.
+            else if (r < 0.95) u |= 1 << bit;                // Quadrante c.
+            else { u |= 1 << bit; v |= 1 << bit; }           // Quadrante d.
+        }
+        if (u == v) continue; // Ignora laços.
+        if (adicionarAmizadeNaLista(rede, u, v)) {
+            adicionarAmizadeNaLista(rede, v, u);
+            amizades++;
+        }
+    }
+    return amizades;
+}
+
+// Função executada por cada thread do benchmark.
+void* executarTarefaBenchmark(void* argumento) {
+    TarefaBenchmark* tarefa = (TarefaBenchmark*)argumento;
+    const RedeSocial* rede = tarefa->rede;
+    // Área de trabalho da thread e buffers de saída, alocados uma vez (fora da medição).
+    AreaTrabalho* area = areaTrabalhoDaThread();
+    int* ordem = (int*)malloc(MAX_USUARIOS * sizeof(int));
+    int* distancia = (int*)malloc(MAX_USUARIOS * sizeof(int));
+    if (!ordem || !distancia) {
+        perror("Erro ao alocar memória para o benchmark");
+        exit(EXIT_FAILURE);
+    }
+    volatile long resultado = 0; // Consome os resultados para que as consultas não sejam eliminadas.
+    for (int q = 0; q < tarefa->consultas; q++) {
+        int a = (int)(proximoAleatorio(&tarefa->semente) % (uint64_t)tarefa->numUsuarios);
+        int b = (int)(proximoAleatorio(&tarefa->semente) % (uint64_t)tarefa->numUsuarios);
+        double inicio = agoraMicrossegundos();
+        switch (tarefa->operacao) {
+            case BENCH_BFS:
+                resultado += BFSNiveis(rede, a, area, NULL);
+                break;
+            case BENCH_DFS: {
+                int contadorGrupo = 0;
+                reiniciarAreaTrabalho(area);
+                DFSUtil(rede, a, area, ordem, &contadorGrupo);
+                resultado += contadorGrupo;
+                break;
+            }
+            case BENCH_SUGERIR_AMIGOS:
+                resultado += calcularSugestoes(rede, a, ordem, distancia, area, NULL);
+                break;
+            case BENCH_CONECTIVIDADE:
+                resultado += verificarConectividade(rede, a, b, area);
+                break;
+            case BENCH_USUARIOS_SIMILARES:
+                resultado += buscarUsuariosSimilares(rede, a, MAX_RESULTADOS_SIMILARES, ordem, distancia);
+                break;
+            case BENCH_DISTANCIA_ORACULO:
+                if (rede->oraculo != NULL) resultado += consultarOraculo(rede->oraculo, a, b, NULL);
+                break;
+            case BENCH_K_SALTOS: {
+                BufferVizinhos buffer = {ordem, distancia, MAX_USUARIOS, 0};
+                resultado += vizinhancaKSaltos(rede, a, SALTOS_BENCHMARK, MAX_RESULTADOS_K_SALTOS_BENCHMARK, true,
+                                               coletarVizinhoNoBuffer, &buffer, area);
+                break;
+            }
+        }
+        tarefa->latencias[q] = agoraMicrossegundos() - inicio;
+    }
+    free(ordem);
+    free(distancia);
+    return NULL;
+}
+
+// Função de comparação de doubles para qsort.
+int compararDoubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Retorna o percentil 'p' (0-100) de um array de latências já ordenado (método do posto mais próximo).
+double percentil(const double* ordenadas, int quantidade, double p) {
+    int posto = (int)(p / 100.0 * quantidade + 0.999999);
+    if (posto < 1) posto = 1;
+    if (posto > quantidade) posto = quantidade;
+    return ordenadas[posto - 1];
+}
+
+// Escreve uma linha de resultados no arquivo CSV: vazão (consultas/s) e percentis de latência (µs).
+void escreverResultadoBenchmark(FILE* saida, const char* operacao, int vertices, long arestas, int threads,
+                                double* latencias, int quantidade, double tempoTotal) {
+    qsort(latencias, (size_t)quantidade, sizeof(double), compararDoubles);
+    fprintf(saida, "social_media,rmat:%s,%d,%ld,%d,%d,%.1f,%.2f,%.2f,%.2f,%.2f\n",
+            operacao, vertices, arestas, threads, quantidade, quantidade / (tempoTotal / 1e6),
+            percentil(latencias, quantidade, 50), percentil(latencias, quantidade, 90),
+            percentil(latencias, quantidade, 99), latencias[quantidade - 1]);
+    fflush(saida);
+}
+
+// Função do modo benchmark: para cada tamanho de rede (potências de 4 até MAX_USUARIOS), gera uma rede
+// R-MAT, mede a construção e mede cada operação com 1, 2, 4 e 8 threads consultando a mesma rede.
+// Os resultados são gravados em CSV (uma linha por operação/tamanho/threads), fácil de comparar entre versões
+// (o formato é o mesmo do benchmark do sistema de rotas).
+// Para redes maiores, compile com -DMAX_USUARIOS=<n> (por exemplo, 65536).
+void executarBenchmark(const char* caminhoSaida) {
+    FILE* saida = fopen(caminhoSaida, "w");
+    if (saida == NULL) {
+        perror("Erro ao criar o arquivo de resultados do benchmark");
+        return;
+    }
+    fprintf(saida, "programa,operacao,vertices,arestas,threads,consultas,vazao_por_s,p50_us,p90_us,p99_us,max_us\n");
+
+    const int contagensThreads[] = {1, 2, 4, 8};
+    double* latencias = (double*)malloc(CONSULTAS_BENCHMARK * sizeof(double));
+    if (!latencias) {
+        perror("Erro ao alocar memória para o benchmark");
+        exit(EXIT_FAILURE);
+    }
+    // As threads recebem uma pilha grande porque DFSUtil é recursiva (profundidade até o número de usuários).
+    pthread_attr_t atributos;
+    pthread_attr_init(&atributos);
+    pthread_attr_setstacksize(&atributos, (size_t)MAX_USUARIOS * 256 + (1 << 20));
+
+    for (int escala = 6; (1 << escala) <= MAX_USUARIOS; escala += 2) {
+        int numUsuarios = 1 << escala;
+        // Mede a construção da rede (usuários + amizades).
+        RedeSocial* rede = criarRedeSocial();
+        double inicio = agoraMicrossegundos();
+        long amizades = gerarRedeRMAT(rede, escala, FATOR_ARESTAS_BENCHMARK, 42 + (uint64_t)escala);
+        double tempoConstrucao = agoraMicrossegundos() - inicio;
+        escreverResultadoBenchmark(saida, "construcao", numUsuarios, amizades, 1, &tempoConstrucao, 1, tempoConstrucao);
+        printf("Rede R-MAT com %d usuários e %ld amizades gerada em %.1f ms.\n",
+               numUsuarios, amizades, tempoConstrucao / 1e3);
+        // Mede a construção paralela do oráculo de distâncias (usado pela operação distanciaOraculo).
+        inicio = agoraMicrossegundos();
+        rede->oraculo = construirOraculoDistancias(rede, NUM_THREADS_ORACULO);
+        double tempoOraculo = agoraMicrossegundos() - inicio;
+        escreverResultadoBenchmark(saida, "construcaoOraculo", numUsuarios, amizades, NUM_THREADS_ORACULO,
+                                   &tempoOraculo, 1, tempoOraculo);
+        // Mede a estimativa da função de vizinhança (HyperANF) até MAX_PASSOS_HYPERANF saltos ou convergir.
+        inicio = agoraMicrossegundos();
+        liberarAnaliseVizinhanca(calcularFuncaoVizinhanca(rede, MAX_PASSOS_HYPERANF));
+        double tempoVizinhanca = agoraMicrossegundos() - inicio;
+        escreverResultadoBenchmark(saida, "funcaoVizinhanca", numUsuarios, amizades, NUM_THREADS_HYPERANF,
+                                   &tempoVizinhanca, 1, tempoVizinhanca);
+        // Mede a contagem paralela de triângulos (com os coeficientes de agrupamento).
+        inicio = agoraMicrossegundos();
+        liberarAnaliseTriangulos(contarTriangulos(rede));
+        double tempoTriangulos = agoraMicrossegundos() - inicio;
+        escreverResultadoBenchmark(saida, "triangulos", numUsuarios, amizades, NUM_THREADS_TRIANGULOS,
+                                   &tempoTriangulos, 1, tempoTriangulos);
+        // Mede a divisão em NUM_PARTICOES_BENCHMARK processos e BFSs particionadas a partir de usuários aleatórios.
+        inicio = agoraMicrossegundos();
+        ExecucaoParticionada* exec = criarExecucaoParticionada(rede, NUM_PARTICOES_BENCHMARK);
+        double tempoParticoes = agoraMicrossegundos() - inicio;
+        escreverResultadoBenchmark(saida, "construcaoParticoes", numUsuarios, amizades, NUM_PARTICOES_BENCHMARK,
+                                   &tempoParticoes, 1, tempoParticoes);
+        uint64_t semente = 7;
+        inicio = agoraMicrossegundos();
+        for (int i = 0; i < CONSULTAS_PARTICIONADAS_BENCHMARK; i++) {
+            double inicioConsulta = agoraMicrossegundos();
+            BFSParticionada(exec, (int)(proximoAleatorio(&semente) % (uint64_t)numUsuarios));
+            latencias[i] = agoraMicrossegundos() - inicioConsulta;
+        }
+        double tempoParticionadas = agoraMicrossegundos() - inicio;
+        escreverResultadoBenchmark(saida, "BFSParticionada", numUsuarios, amizades, NUM_PARTICOES_BENCHMARK,
+                                   latencias, CONSULTAS_PARTICIONADAS_BENCHMARK, tempoParticionadas);
+        long arestasCortadas = 0;
+        for (int p = 0; p < NUM_PARTICOES_BENCHMARK; p++) arestasCortadas += exec->particoes[p]->arestasCortadas;
+        printf("Corte da divisão em %d processos: %.1f%% das amizades.\n", NUM_PARTICOES_BENCHMARK,
+               amizades > 0 ? 100.0 * (double)arestasCortadas / 2 / (double)amizades : 0.0);
+        liberarExecucaoParticionada(exec);
+
+        for (int operacao = 0; operacao < NUM_OPERACOES_BENCHMARK; operacao++) {
+            for (size_t t = 0; t < sizeof(contagensThreads) / sizeof(contagensThreads[0]); t++) {
+                int numThreads = contagensThreads[t];
+                pthread_t threads[8];
+                TarefaBenchmark tarefas[8];
+                // Divide o total de consultas entre as threads (a última recebe o resto).
+                int porThread = CONSULTAS_BENCHMARK / numThreads;
+                inicio = agoraMicrossegundos();
+                for (int i = 0; i < numThreads; i++) {
+                    tarefas[i].rede = rede;
+                    tarefas[i].numUsuarios = numUsuarios;
+                    tarefas[i].operacao = operacao;
+                    tarefas[i].consultas = i == numThreads - 1 ? CONSULTAS_BENCHMARK - porThread * i : porThread;
+                    tarefas[i].semente = 1000 + (uint64_t)i;
+                    tarefas[i].latencias = latencias + porThread * i;
+                    pthread_create(&threads[i], &atributos, executarTarefaBenchmark, &tarefas[i]);
+                }
+                for (int i = 0; i < numThreads; i++) pthread_join(threads[i], NULL);
+                double tempoTotal = agoraMicrossegundos() - inicio;
+                escreverResultadoBenchmark(saida, nomesOperacoesBenchmark[operacao], numUsuarios, amizades,
+                                           numThreads, latencias, CONSULTAS_BENCHMARK, tempoTotal);
+            }
+        }
+        liberarRedeSocial(rede);
+    }
+    pthread_attr_destroy(&atributos);
+    free(latencias);
+    fclose(saida);
+    printf("Resultados do benchmark gravados em %s.\n", caminhoSaida);
+}
+
+
 // Função principal do programa.
-int main() {
+// Com os argumentos "--servidor <caminho do socket>", executa como servidor de consultas em vez do menu.
+// Com "--benchmark <arquivo.csv>", gera redes sintéticas, mede as consultas e grava os resultados no arquivo.
+// "--estatisticas" antes desses argumentos (ou sozinho, para o menu) ativa as estatísticas por consulta.
+int main(int argc, char* argv[]) {
     // Tenta configurar a localidade para pt_BR.UTF-8 para exibir caracteres acentuados corretamente.
     // Faz algumas tentativas com diferentes strings de localidade comuns para sistemas Windows e Linux.
     if (setlocale(LC_ALL, "pt_BR.UTF-8") == NULL) {
@@ -484,6 +3623,25 @@ int main() {
         }
     }
 
+    // Ativa a coleta de estatísticas das consultas (mostradas a cada consulta e agregadas ao sair).
+    if (argc >= 2 && strcmp(argv[1], "--estatisticas") == 0) {
+#ifdef SEM_ESTATISTICAS
+        fprintf(stderr, "Erro: programa compilado com -DSEM_ESTATISTICAS; a opção --estatisticas não está disponível.\n");
+        return EXIT_FAILURE;
+#else
+        estatisticasAtivas = true;
+        argv++;
+        argc--;
+#endif
+    }
+
+    // Modo benchmark: usa apenas redes geradas (não carrega nem altera os dados persistidos).
+    if (argc >= 3 && strcmp(argv[1], "--benchmark") == 0) {
+        executarBenchmark(argv[2]);
+        liberarAreaTrabalhoDaThread();
+        return 0;
+    }
+
     // Cria a rede social.
     RedeSocial* rede = criarRedeSocial();
     // Variáveis para armazenar a opção do menu, nome e IDs de usuários.
@@ -491,22 +3649,37 @@ int main() {
     char nome[MAX_NOME_USUARIO];
     int id1, id2;
 
-    // Adiciona alguns usuários iniciais para teste e demonstração.
-    int idAlice = adicionarUsuario(rede, "Alice");
-    int idBob = adicionarUsuario(rede, "Bob");
-    int idCharlie = adicionarUsuario(rede, "Charlie");
-    int idDavid = adicionarUsuario(rede, "David");
-    int idEve = adicionarUsuario(rede, "Eve");
-    int idFrank = adicionarUsuario(rede, "Frank"); // Usuário isolado inicialmente
+    // Carrega o estado salvo em disco (snapshot + journal) e passa a registrar as novas operações.
+    long operacoesNoJournal;
+    long tamanhoJournal = carregarRedeSocial(rede, &operacoesNoJournal);
+    abrirJournal(rede, tamanhoJournal, operacoesNoJournal);
 
-    // Cria algumas conexões iniciais entre os usuários, verificando se os IDs são válidos.
-    if(idAlice != -1 && idBob != -1) criarConexao(rede, idAlice, idBob);
-    if(idAlice != -1 && idCharlie != -1) criarConexao(rede, idAlice, idCharlie);
-    if(idBob != -1 && idDavid != -1) criarConexao(rede, idBob, idDavid);
-    if(idCharlie != -1 && idDavid != -1) criarConexao(rede, idCharlie, idDavid);
-    if(idDavid != -1 && idEve != -1) criarConexao(rede, idDavid, idEve);
+    // Na primeira execução (nada persistido), adiciona alguns usuários iniciais para teste e demonstração.
+    if (rede->numUsuariosAtivos == 0) {
+        int idAlice = adicionarUsuario(rede, "Alice");
+        int idBob = adicionarUsuario(rede, "Bob");
+        int idCharlie = adicionarUsuario(rede, "Charlie");
+        int idDavid = adicionarUsuario(rede, "David");
+        int idEve = adicionarUsuario(rede, "Eve");
+        int idFrank = adicionarUsuario(rede, "Frank"); // Usuário isolado inicialmente
+
+        // Cria algumas conexões iniciais entre os usuários, verificando se os IDs são válidos.
+        if(idAlice != -1 && idBob != -1) criarConexao(rede, idAlice, idBob);
+        if(idAlice != -1 && idCharlie != -1) criarConexao(rede, idAlice, idCharlie);
+        if(idBob != -1 && idDavid != -1) criarConexao(rede, idBob, idDavid);
+        if(idCharlie != -1 && idDavid != -1) criarConexao(rede, idCharlie, idDavid);
+        if(idDavid != -1 && idEve != -1) criarConexao(rede, idDavid, idEve);
+    }
 
 
+    // Modo servidor: atende consultas pelo socket até receber SIGINT/SIGTERM.
+    if (argc >= 3 && strcmp(argv[1], "--servidor") == 0) {
+        executarServidor(rede, argv[2]);
+        fecharJournal(rede);
+        liberarRedeSocial(rede);
+        return 0;
+    }
+
     // Loop principal do menu da aplicação. Continua até o usuário escolher a opção 0 (Sair).
     do {
         exibirMenuRedeSocial(); // Mostra o menu.
@@ -574,23 +3747,76 @@ int main() {
                 if (scanf("%d", &id2) != 1) { printf("ID inválido.\n"); while (getchar() != '\n'); break; }
                 getchar(); // Consome o newline.
                 // Verifica a conectividade e imprime o resultado.
-                if (verificarConectividade(rede, id1, id2)) {
-                    printf("%s (ID: %d) e %s (ID: %d) ESTÃO conectados.\n", rede->usuarios[id1].nome, id1, rede->usuarios[id2].nome, id2);
+                if (verificarConectividade(rede, id1, id2, NULL)) {
+                    printf("%s (ID: %d) e %s (ID: %d) ESTÃO conectados.\n", nomeUsuario(rede, id1), id1, nomeUsuario(rede, id2), id2);
                 } else {
-                    printf("%s (ID: %d) e %s (ID: %d) NÃO ESTÃO conectados.\n", rede->usuarios[id1].nome, id1, rede->usuarios[id2].nome, id2);
+                    printf("%s (ID: %d) e %s (ID: %d) NÃO ESTÃO conectados.\n", nomeUsuario(rede, id1), id1, nomeUsuario(rede, id2), id2);
                 }
                 break;
             case 9: // Listar todos os usuários ativos
                 listarUsuariosAtivos(rede);
                 break;
+            case 10: // Buscar Usuários Similares
+                printf("Digite o ID do usuário para buscar usuários similares: ");
+                if (scanf("%d", &id1) != 1) { printf("ID inválido.\n"); while (getchar() != '\n'); break; }
+                getchar(); // Consome o newline.
+                usuariosSimilares(rede, id1);
+                break;
+            case 11: // Distância entre dois Usuários
+                printf("Digite o ID do primeiro usuário: ");
+                if (scanf("%d", &id1) != 1) { printf("ID inválido.\n"); while (getchar() != '\n'); break; }
+                printf("Digite o ID do segundo usuário: ");
+                if (scanf("%d", &id2) != 1) { printf("ID inválido.\n"); while (getchar() != '\n'); break; }
+                getchar(); // Consome o newline.
+                distanciaEntreUsuarios(rede, id1, id2);
+                break;
+            case 12: // Alcance em k Saltos (HyperANF)
+                printf("Digite o número máximo de saltos: ");
+                if (scanf("%d", &id1) != 1) { printf("Número inválido.\n"); while (getchar() != '\n'); break; }
+                printf("Digite o ID de um usuário para comparar com o alcance exato (-1 para nenhum): ");
+                if (scanf("%d", &id2) != 1) { printf("ID inválido.\n"); while (getchar() != '\n'); break; }
+                getchar(); // Consome o newline.
+                analisarVizinhanca(rede, id1, id2);
+                break;
+            case 13: // Triângulos e Coeficientes de Agrupamento
+                analisarTriangulos(rede);
+                break;
+            case 14: { // Usuários a até k Saltos
+                int saltos, limite, ordenar;
+                printf("Digite o ID do usuário: ");
+                if (scanf("%d", &id1) != 1) { printf("ID inválido.\n"); while (getchar() != '\n'); break; }
+                printf("Digite o número máximo de saltos: ");
+                if (scanf("%d", &saltos) != 1) { printf("Número inválido.\n"); while (getchar() != '\n'); break; }
+                printf("Digite o número máximo de resultados (0 para todos): ");
+                if (scanf("%d", &limite) != 1) { printf("Número inválido.\n"); while (getchar() != '\n'); break; }
+                printf("Ordenar cada nível por ID? (1 = sim, 0 = não): ");
+                if (scanf("%d", &ordenar) != 1) { printf("Opção inválida.\n"); while (getchar() != '\n'); break; }
+                getchar(); // Consome o newline.
+                vizinhosEmKSaltos(rede, id1, saltos, limite, ordenar != 0);
+                break;
+            }
+            case 15: // BFS Particionada em Vários Processos
+                printf("Digite o ID do usuário para iniciar a BFS: ");
+                if (scanf("%d", &id1) != 1) { printf("ID inválido.\n"); while (getchar() != '\n'); break; }
+                printf("Digite o número de processos (1 a %d): ", MAX_PARTICOES);
+                if (scanf("%d", &id2) != 1) { printf("Número inválido.\n"); while (getchar() != '\n'); break; }
+                getchar(); // Consome o newline.
+                BFSEmParticoes(rede, id1, id2);
+                break;
             case 0: // Sair
                 printf("Saindo da Rede Social Simulada...\n");
                 break;
             default: // Opção inválida
                 printf("Opção inválida. Tente novamente.\n");
         }
+        // Torna duráveis as operações feitas nesta opção (um único fsync para o lote).
+        sincronizarPersistencia(rede);
     } while (opcao != 0); // Continua o loop até que a opção seja 0.
 
+    if (estatisticasAtivas) imprimirHistogramas(stdout, agregadosMenu);
+    liberarAreaTrabalhoDaThread();
+    // Fecha o journal, garantindo que nenhuma operação pendente seja perdida.
+    fecharJournal(rede);
     // Libera a memória alocada para a rede social antes de encerrar o programa.
     liberarRedeSocial(rede);
     // Retorna 0 indicando que o programa terminou com sucesso.